@@ -41,15 +41,24 @@ int main () {
   CrankNicolsonScheme scheme;
 
   //
-  // Constructing pricer and pricing option sample
+  // Constructing pricer and pricing option sample on all hardware threads
   // 
   FDMPricer pricer(scheme, solver, grid, grid, range_setter);
   
+  std::vector<PricingRequest> requests;
+  for (auto market : markets) {
+    for (auto option : options) {
+      requests.push_back(PricingRequest {market.second, option.second, 500, 800});
+    }  // options
+  }  // markets
+  auto fdm_prices = pricer.priceBatch(requests);
+
   DataFrame results;
+  unsigned int i = 0;
   for (auto market : markets) {
     for (auto option : options) {
       double analytic_price = BSprice(market.second, option.second);
-      double fdm_price = pricer.price(market.second, option.second, 500, 800);
+      double fdm_price = fdm_prices.at(i++);
       
       DataEntryClerk input;
       input.add("Market", market.first);
@@ -0,0 +1,131 @@
+#include <marian.hpp>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+using namespace marian;
+
+/**
+ * @example adaptiveTimeSteppingExample.cpp
+ *
+ * \brief Example compares adaptive time stepping (AdaptiveScheme with TR-BDF2 scheme) with uniform time grids.
+ *
+ * For each tolerance the PDE is solved by marian::AdaptiveScheme and the smallest uniform time grid of TR-BDF2 scheme
+ * giving the same error is searched. Errors are measured against the solution on the same spatial grid with very fine
+ * time grid, so only the error of time discretization is compared. Number of steps of adaptive scheme includes rejected steps.
+ *
+ * Two problems are solved:
+ * - diffusion equation with zero initial condition and boundary value switched on quickly shortly before the final time,
+ *   where the steps have to be short only around the switch, so the adaptive scheme needs fewer steps than uniform grid,
+ * - Black-Scholes equation of European call. Coefficients and boundary conditions do not depend on time, so the local error
+ *   of every step propagated to the final time has the same size (\f$C dt^3 L^3 V(T)\f$), whether the step is close to payoff date
+ *   or not. Uniform grid is optimal then and adaptive scheme, which makes the steps near payoff date short, needs more steps.
+ *
+ * Example returns non-zero code if adaptive scheme does not need fewer steps than uniform grid for the diffusion problem.
+ */
+
+/** \brief Maximal absolute difference of two solutions
+ */
+double maxError(const std::vector<double>& f, const std::vector<double>& reference) {
+  double err = 0.0;
+  for (unsigned int i = 0; i < f.size(); i++) {
+    err = std::max(err, std::fabs(f[i] - reference[i]));
+  }
+  return err;
+}
+
+/** \brief Solves the problem with adaptive scheme for given tolerances and compares it with uniform grids of the same error
+ *
+ * \param solve Solves the problem with given scheme and number of time steps of initial time grid, returns the error
+ * \return True if adaptive scheme needs fewer steps than uniform grid for all tolerances
+ */
+bool compare(const std::function<double(FDScheme&, int)>& solve) {
+  LUSolver solver;
+  TRBDF2Scheme uniform(solver);
+  bool fewer = true;
+  printf("%8s %10s %10s %10s %10s %12s %12s\n", "tol", "adaptive", "rejected", "error", "uniform", "adaptive ms", "uniform ms");
+  for (double tolerance : {1e-4, 1e-5, 1e-6}) {
+    AdaptiveScheme adaptive(TRBDF2Scheme(solver), tolerance);
+    auto start = std::chrono::steady_clock::now();
+    double error = solve(adaptive, 100);
+    double adaptive_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    unsigned int rejected = adaptive.getRejectedSteps();
+    unsigned int steps = adaptive.getTimeGrid().size() - 1 + rejected;
+
+    // smallest uniform grid with error not larger than the error of adaptive scheme
+    int low = 1;
+    int upp = 2;
+    while (solve(uniform, upp) > error) {
+      low = upp;
+      upp *= 2;
+    }
+    while (upp - low > 1) {
+      int mid = (low + upp) / 2;
+      (solve(uniform, mid) > error ? low : upp) = mid;
+    }
+    start = std::chrono::steady_clock::now();
+    solve(uniform, upp);
+    double uniform_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%8.0e %10u %10u %10.2e %10d %12.3f %12.3f\n", tolerance, steps, rejected, error, upp, adaptive_time, uniform_time);
+    fewer = fewer && steps < static_cast<unsigned int>(upp);
+  }
+  return fewer;
+}
+
+int main() {
+  LUSolver solver;
+  UniformGridBuilder grid;
+
+  //
+  // Diffusion equation with boundary value switched on at t = 0.9
+  //
+  ConvectionDiffusion process;
+  process.diffusion = 0.5;
+  process.convection = 0.0;
+  process.decay = 0.0;
+  auto spatial_grid = grid.buildGrid(-1.0, 1.0, 201);
+  auto low_value = [](double t)->double{return 0.5 * (1.0 + std::tanh((t - 0.9) / 0.002));};
+  auto upp_value = [](double)->double{return 0.0;};
+  DirichletBoundaryCondition<decltype(low_value)> lowbc(BCSide::LOW, low_value);
+  DirichletBoundaryCondition<decltype(upp_value)> uppbc(BCSide::UPP, upp_value);
+  std::vector<SmartPointer<BoundaryCondition> > bcs {lowbc, uppbc};
+  std::vector<double> initial(spatial_grid.size(), 0.0);
+  ForwardKolmogorowEquation equation(process);
+  auto L = equation.getOperator(spatial_grid);
+  TRBDF2Scheme reference_scheme(solver);
+  auto reference = reference_scheme.solve(initial, bcs, grid.buildGrid(0.0, 1.0, 100001), L);
+
+  printf("Diffusion with boundary value switched on at t = 0.9, error in maximum norm\n");
+  bool ok = compare([&](FDScheme& scheme, int Nt) {
+      return maxError(scheme.solve(initial, bcs, grid.buildGrid(0.0, 1.0, Nt + 1), L), reference);
+    });
+
+  //
+  // Black-Scholes equation of European call
+  //
+  EuroOpt option(1.0, 1.0, OptionType::CALL);
+  Market market;
+  market.spot = 1.0;
+  market.vol = 0.2;
+  market.r = 0.05;
+  SpotRelatedRange range_setter(0.2, 3.0);
+  FDMPricer pricer(TRBDF2Scheme(solver), solver, grid, grid, range_setter);
+  auto plan = pricer.prepare(market, option, 801, 20001);
+  BackwardKolmogorowEquation bs_equation(mkt2process(market));
+  auto bs_L = bs_equation.getOperator(plan.identity(), plan.firstDerivative(), plan.secondDerivative());
+  auto price = [&](FDScheme& scheme, const std::vector<double>& time_grid) {
+    auto solution = scheme.solve(plan.initialCondition(), plan.boundaryConditions(), time_grid, bs_L);
+    return interpolation(plan.spotGrid(), solution, market.spot);
+  };
+  double reference_price = price(reference_scheme, plan.backwardTimeGrid());
+
+  printf("European call, error of price\n");
+  compare([&](FDScheme& scheme, int Nt) {
+      auto time_grid = grid.buildGrid(0.0, option.getT(), Nt + 1);
+      std::reverse(time_grid.begin(), time_grid.end());
+      return std::fabs(price(scheme, time_grid) - reference_price);
+    });
+
+  printf("%s\n", ok ? "Adaptive scheme needs fewer steps for diffusion problem" : "Adaptive scheme does not need fewer steps for diffusion problem");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include <marian.hpp>
+#include <cstdio>
+
+using namespace marian;
+
+/**
+ * @example sensitivitiesExample.cpp
+ *
+ * \brief Example compares sensitivities of FDM pricer calculated in dual numbers and in adjoint mode with bump and reprice.
+ *
+ * Delta is calculated from the solution by the same three point formula in priceWithGreeks, priceWithSensitivities
+ * and priceAdjoint, so all three deltas are equal and are compared with the analytical delta.
+ *
+ * Vega and rho of priceWithSensitivities and priceAdjoint are derivatives of the discrete solution on fixed grid.
+ * They are compared with central differences of prices:
+ * - repriced with the plan prepared for the base market (fixed grid), which should match up to the error of finite difference,
+ * - repriced with the grid prepared for bumped market, which differ by the effect of moving the grid,
+ * - of analytical prices.
+ *
+ * Range of marian::SpotRelatedRange depends only on spot, so its vega and rho are not affected by moving the grid.
+ * Range proportional to standard deviation of log-spot (defined below) moves with volatility, vega of fixed grid
+ * differs from bump and reprice by the change of discretization error.
+ *
+ * Example returns non-zero code if sensitivities do not match the fixed grid bumps or deltas differ.
+ */
+
+/** \brief Range of \f$\pm 5 \sigma \sqrt{T}\f$ in log-spot around spot
+ */
+class VolatilityRange : public DCRangeSetup<VolatilityRange> {
+public:
+  double getUpperBound(Market mkt, SmartPointer<Option> option) const override {
+    return mkt.spot * std::exp(5.0 * mkt.vol * std::sqrt(option->getT()));
+  }
+  double getLowerBound(Market mkt, SmartPointer<Option> option) const override {
+    return mkt.spot * std::exp(-5.0 * mkt.vol * std::sqrt(option->getT()));
+  }
+};
+
+int main() {
+  //
+  // Preparing building blocks of PDE solver
+  //
+  LUSolver solver;
+  UniformGridBuilder grid;
+  CrankNicolsonScheme scheme(solver, 2);
+  BasicLUSolver<Dual> dual_solver;
+  BasicCrankNicolsonScheme<Dual> dual_scheme(dual_solver, 2);
+  std::vector<SmartPointer<RangeSetup> > ranges {SpotRelatedRange(0.2, 3.0), VolatilityRange()};
+
+  //
+  // Constructing option and market
+  //
+  EuroOpt option(1.0, 1.0, OptionType::CALL);
+  Market market;
+  market.spot = 1.05;
+  market.vol = 0.25;
+  market.r = 0.02;
+  int Ns = 201;
+  int Nt = 200;
+
+  bool ok = true;
+  for (auto& range : ranges) {
+    FDMPricer pricer(scheme, solver, grid, grid, range);
+    pricer.setSensitivityScheme(dual_scheme, dual_solver);
+
+    //
+    // Sensitivities from single solve
+    //
+    auto greeks = pricer.priceWithGreeks(market, option, Ns, Nt);
+    auto dual = pricer.priceWithSensitivities(market, option, Ns, Nt);
+    auto adjoint = pricer.priceAdjoint(market, option, Ns, Nt);
+
+    //
+    // Bump and reprice with fixed and moving grid and analytical prices
+    //
+    auto plan = pricer.prepare(market, option, Ns, Nt);
+    double bump = 1e-4;
+    double fixed[3], moving[3], analytic[3];
+    for (int k = 0; k < 3; ++k) {
+      Market up = market;
+      Market down = market;
+      double& up_input = k == 0 ? up.spot : (k == 1 ? up.vol : up.r);
+      double& down_input = k == 0 ? down.spot : (k == 1 ? down.vol : down.r);
+      up_input += bump;
+      down_input -= bump;
+      fixed[k] = (pricer.price(plan, up) - pricer.price(plan, down)) / (2.0 * bump);
+      moving[k] = (pricer.price(up, option, Ns, Nt) - pricer.price(down, option, Ns, Nt)) / (2.0 * bump);
+      analytic[k] = (BSprice(up, option) - BSprice(down, option)) / (2.0 * bump);
+    }
+
+    printf("%s range\n", &range == &ranges.front() ? "Spot related" : "Volatility related");
+    printf("%-8s %12s %12s %12s %12s %12s %12s\n", "", "greeks", "dual", "adjoint", "fixed grid", "moving grid", "analytic");
+    printf("%-8s %12.8f %12.8f %12.8f %12s %12.8f %12.8f\n", "delta", greeks.delta, dual.tangent(0), adjoint.tangent(0), "-", moving[0], analytic[0]);
+    printf("%-8s %12s %12.8f %12.8f %12.8f %12.8f %12.8f\n", "vega", "-", dual.tangent(1), adjoint.tangent(1), fixed[1], moving[1], analytic[1]);
+    printf("%-8s %12s %12.8f %12.8f %12.8f %12.8f %12.8f\n", "rho", "-", dual.tangent(2), adjoint.tangent(2), fixed[2], moving[2], analytic[2]);
+
+    //
+    // Checking consistency
+    //
+    double tolerance = 1e-6;
+    ok = ok && std::fabs(dual.tangent(0) - greeks.delta) < tolerance && std::fabs(adjoint.tangent(0) - greeks.delta) < tolerance;
+    for (int k = 1; k < 3; ++k) {
+      ok = ok && std::fabs(dual.tangent(k) - fixed[k]) < tolerance && std::fabs(adjoint.tangent(k) - fixed[k]) < tolerance;
+    }
+  }
+  printf("%s\n", ok ? "Sensitivities match bump and reprice on fixed grid" : "Sensitivities do not match bump and reprice on fixed grid");
+  return ok ? 0 : 1;
+}
@@ -1,4 +1,6 @@
 #include <FDM/LUSolver.hpp>
+#include <utils/dualNumber.hpp>
+#include <algorithm>
 
 namespace marian {
 
@@ -13,24 +15,149 @@ namespace marian {
    * \param w Vector of real numbers
    * \return Vector of real numbers being solution of system: \f$w = A \times v\f$ 
    */  
-  std::vector<double> LUSolver::solve(const TridiagonalOperator& A,
-				      const std::vector<double>& w) const {
+  template<typename Real>
+  std::vector<Real> BasicLUSolver<Real>::solve(const BasicTridiagonalOperator<Real>& A,
+					       const std::vector<Real>& w) const {
+    std::vector<Real> ret(A.size(), Real(0.0));
+    BasicSolverWorkspace<Real> ws;
+    solve(A, w, ret, ws);
+    return ret;
+  }
+
+  /** \brief Method solves tridiagonal system writing the solution to provided vector
+   *
+   * Method solves the system using LU method, intermediate factors are stored in workspace. 
+   * Vectors \b w and \b v may be the same vector.
+   *
+   * \param A Tridiagonal matrix defining tridiagonal system
+   * \param w Vector of real numbers
+   * \param v Vector of size equal to size of A, overwritten by solution of system: \f$w = A \times v\f$ 
+   * \param ws Workspace reused between calls
+   */  
+  template<typename Real>
+  void BasicLUSolver<Real>::solve(const BasicTridiagonalOperator<Real>& A,
+				  const std::vector<Real>& w,
+				  std::vector<Real>& v,
+				  BasicSolverWorkspace<Real>& ws) const {
     auto size = A.size();
-    std::vector<double> ret  (size, 0.0);
-    std::vector<double> temp (size, 0.0);
-    double bet = A.mid(0);
+    auto& temp = ws.temp;
+    temp.resize(size);
+    Real bet = A.mid(0);
 
-    ret.at(0) = w.at(0) / bet;
+    v.at(0) = w.at(0) / bet;
     for (int j = 1; j <= size - 1; ++j) {
-      temp.at(j) = A.upp(j-1) / bet;
-      bet = A.mid(j) - A.low(j-1) * temp.at(j);
-      ret.at(j) = ( w.at(j) - A.low(j-1) * ret.at(j-1) ) / bet;
+      temp[j] = A.upp(j-1) / bet;
+      bet = A.mid(j) - A.low(j-1) * temp[j];
+      v[j] = ( w[j] - A.low(j-1) * v[j-1] ) / bet;
     }
 
     for (int j = size - 2; j>0; --j)
-      ret.at(j) -= temp.at(j+1)*ret.at(j+1);
-    ret.at(0) -= temp.at(1)*ret.at(1);
+      v[j] -= temp[j+1]*v[j+1];
+    v[0] -= temp[1]*v[1];
+  }
+  
+  /** \brief Computes LU factors of tridiagonal matrix
+   *
+   * Method performs the forward-elimination part of LU method once and stores the factors. 
+   * The pivots are stored inverted, so solveFactorized does not perform any division.
+   *
+   * \param A Tridiagonal matrix defining tridiagonal system
+   */
+  template<typename Real>
+  void BasicLUSolver<Real>::factorize(const BasicTridiagonalOperator<Real>& A) {
+    BasicTridiagonalSolver<Real>::factorize(A);
+    auto size = A.size();
+    low_.resize(size);
+    gam_.assign(size, Real(0.0));
+    ibet_.resize(size);
+
+    Real bet = A.mid(0);
+    ibet_.at(0) = 1.0 / bet;
+    for (int j = 1; j <= size - 1; ++j) {
+      low_.at(j) = A.low(j-1);
+      gam_.at(j) = A.upp(j-1) / bet;
+      bet = A.mid(j) - low_.at(j) * gam_.at(j);
+      ibet_.at(j) = 1.0 / bet;
+    }
+  }
+
+  /** \brief Solves tridiagonal system using factors computed by factorize
+   *
+   * Only forward and backward substitution are performed.
+   *
+   * \param w Vector of real numbers
+   * \return Vector of real numbers being solution of system: \f$w = A \times v\f$ 
+   */
+  template<typename Real>
+  std::vector<Real> BasicLUSolver<Real>::solveFactorized(const std::vector<Real>& w) const {
+    std::vector<Real> ret(ibet_.size());
+    solveFactorized(w, ret);
     return ret;
   }
+
+  /** \brief Solves tridiagonal system using factors computed by factorize writing the solution to provided vector
+   *
+   * Only forward and backward substitution are performed, no memory is allocated. 
+   * Vectors \b w and \b v may be the same vector.
+   *
+   * \param w Vector of real numbers
+   * \param v Vector of size equal to size of factorized matrix, overwritten by solution of system: \f$w = A \times v\f$ 
+   */
+  template<typename Real>
+  void BasicLUSolver<Real>::solveFactorized(const std::vector<Real>& w, std::vector<Real>& v) const {
+    auto size = ibet_.size();
+
+    v[0] = w[0] * ibet_[0];
+    for (unsigned int j = 1; j < size; ++j) {
+      v[j] = (w[j] - low_[j] * v[j-1]) * ibet_[j];
+    }
+
+    for (unsigned int j = size - 1; j > 0; --j) {
+      v[j-1] -= gam_[j] * v[j];
+    }
+  }
   
+  template<typename Real>
+  const unsigned int BasicLUSolver<Real>::BLOCK;
+
+  /** \brief Solves tridiagonal systems with many right-hand sides using factors computed by factorize
+   *
+   * Right-hand sides are processed in blocks of 8 columns. Forward and backward substitution sweep through the rows once per block 
+   * and each row of factors is applied to all columns of the block, so the factors are loaded from memory once per block 
+   * and the columns of the block stay in cache between the sweeps.
+   *
+   * \param columns Right-hand sides, overwritten by solutions
+   */
+  template<typename Real>
+  void BasicLUSolver<Real>::solveFactorized(std::vector<std::vector<Real> >& columns) const {
+    auto size = ibet_.size();
+    Real* x[BLOCK];
+    for (unsigned int first = 0; first < columns.size(); first += BLOCK) {
+      unsigned int width = std::min<unsigned int>(BLOCK, columns.size() - first);
+      for (unsigned int c = 0; c < width; ++c) {
+	x[c] = columns[first + c].data();
+	x[c][0] *= ibet_[0];
+      }
+
+      for (unsigned int j = 1; j < size; ++j) {
+	Real low = low_[j];
+	Real ibet = ibet_[j];
+	for (unsigned int c = 0; c < width; ++c) {
+	  x[c][j] = (x[c][j] - low * x[c][j-1]) * ibet;
+	}
+      }
+
+      for (unsigned int j = size - 1; j > 0; --j) {
+	Real gam = gam_[j];
+	for (unsigned int c = 0; c < width; ++c) {
+	  x[c][j-1] -= gam * x[c][j];
+	}
+      }
+    }
+  }
+
+  // instantiations for supported types of elements
+  template class BasicLUSolver<double>;
+  template class BasicLUSolver<float>;
+  template class BasicLUSolver<Dual>;
 }  // namespace marian
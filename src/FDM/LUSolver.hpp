@@ -9,20 +9,41 @@ namespace marian {
    *
    *  Method solves tridiagonal system using LU method (see \cite capinski)
    */
-
-  class LUSolver : public DCTridiagonalSolver<LUSolver> {
+  template<typename Real>
+  class BasicLUSolver : public DCTridiagonalSolver<BasicLUSolver<Real>, Real> {
   public:
     /** \brief Constructor
      */
-    LUSolver(){};
+    BasicLUSolver(){};
+
+    virtual std::vector<Real> solve(const BasicTridiagonalOperator<Real>& A,
+				    const std::vector<Real>& w) const override;
 
-    virtual std::vector<double> solve(const TridiagonalOperator& A,
-				      const std::vector<double>& w) const override;
+    void solve(const BasicTridiagonalOperator<Real>& A,
+	       const std::vector<Real>& w,
+	       std::vector<Real>& v,
+	       BasicSolverWorkspace<Real>& ws) const override;
+
+    void factorize(const BasicTridiagonalOperator<Real>& A) override;
+    std::vector<Real> solveFactorized(const std::vector<Real>& w) const override;
+    void solveFactorized(const std::vector<Real>& w, std::vector<Real>& v) const override;
+    void solveFactorized(std::vector<std::vector<Real> >& columns) const override;
 
     /** \brief Constructor
      */
-    ~LUSolver(){};
+    ~BasicLUSolver(){};
+  private:
+    static const unsigned int BLOCK = 8; /*!< \brief Number of right-hand sides substituted in one sweep*/
+
+    std::vector<Real> low_;  /*!< \brief Lower diagonal of factorized matrix*/
+    std::vector<Real> gam_;  /*!< \brief Upper diagonal of U factor*/
+    std::vector<Real> ibet_; /*!< \brief Inverted pivots of U factor*/
   };
+
+  /** \ingroup fdm
+   * \brief LU solver of systems of doubles
+   */
+  typedef BasicLUSolver<double> LUSolver;
   
 }  // namespace marian
 
@@ -0,0 +1,121 @@
+#include <FDM/batchLUSolver.hpp>
+#include <algorithm>
+
+namespace marian {
+
+  /** \brief Computes LU factors of tridiagonal matrices
+   *
+   * Matrices are copied to interleaved layout and factorized simultaneously.
+   * If less than marian::BATCH_WIDTH matrices are given, remaining lanes are filled with identity matrices.
+   *
+   * \param A Tridiagonal matrices of the same size, at most marian::BATCH_WIDTH
+   */
+  void BatchLUSolver::factorize(const std::vector<TridiagonalOperator>& A) {
+    const int W = BATCH_WIDTH;
+    factorized_ = A;
+    size_ = A.front().size();
+    low_.assign(size_ * W, 0.0);
+    gam_.assign(size_ * W, 0.0);
+    ibet_.assign(size_ * W, 1.0);
+
+    // low_, gam_ and ibet_ hold lower, upper and mid diagonal before factorization
+    for (unsigned int k = 0; k < A.size(); ++k) {
+      for (unsigned int j = 1; j < size_; ++j) {
+	low_[j*W + k] = A[k].evalLow(j-1);
+	gam_[j*W + k] = A[k].evalUpp(j-1);
+      }
+      for (unsigned int j = 0; j < size_; ++j) {
+	ibet_[j*W + k] = A[k].evalMid(j);
+      }
+    }
+
+    double* low  = low_.data();
+    double* gam  = gam_.data();
+    double* ibet = ibet_.data();
+    for (int k = 0; k < W; ++k) {
+      ibet[k] = 1.0 / ibet[k];
+    }
+    for (unsigned int j = 1; j < size_; ++j) {
+      for (int k = 0; k < W; ++k) {
+	gam[j*W + k] *= ibet[(j-1)*W + k];
+	ibet[j*W + k] = 1.0 / (ibet[j*W + k] - low[j*W + k] * gam[j*W + k]);
+      }
+    }
+  }
+
+  /** \brief Checks if given matrices are the ones that were passed to factorize
+   */
+  bool BatchLUSolver::isFactorized(const std::vector<TridiagonalOperator>& A) const {
+    return factorized_.size() == A.size() && std::equal(A.begin(), A.end(), factorized_.begin());
+  }
+
+  /** \brief Solves factorized systems for interleaved right-hand sides
+   *
+   * \param x Right-hand sides in interleaved layout (size of systems times marian::BATCH_WIDTH), overwritten by solutions
+   */
+  void BatchLUSolver::solveFactorized(std::vector<double>& x) const {
+    const int W = BATCH_WIDTH;
+    const double* low  = low_.data();
+    const double* gam  = gam_.data();
+    const double* ibet = ibet_.data();
+    double* v = x.data();
+
+    for (int k = 0; k < W; ++k) {
+      v[k] *= ibet[k];
+    }
+    for (unsigned int j = 1; j < size_; ++j) {
+      for (int k = 0; k < W; ++k) {
+	v[j*W + k] = (v[j*W + k] - low[j*W + k] * v[(j-1)*W + k]) * ibet[j*W + k];
+      }
+    }
+    for (unsigned int j = size_ - 1; j > 0; --j) {
+      for (int k = 0; k < W; ++k) {
+	v[(j-1)*W + k] -= gam[j*W + k] * v[j*W + k];
+      }
+    }
+  }
+
+  /** \brief Solves factorized systems
+   *
+   * Right-hand sides are packed to interleaved layout, systems are solved and solutions are unpacked.
+   *
+   * \param f Right-hand sides, one vector for each factorized matrix, overwritten by solutions
+   */
+  void BatchLUSolver::solveFactorized(std::vector<std::vector<double> >& f) {
+    pack(f, buffer_);
+    solveFactorized(buffer_);
+    unpack(buffer_, f);
+  }
+
+  /** \brief Converts vectors to interleaved layout
+   *
+   * \param f Vectors, at most marian::BATCH_WIDTH
+   * \param x Interleaved vectors, lanes not used are filled with zeros
+   */
+  void BatchLUSolver::pack(const std::vector<std::vector<double> >& f, std::vector<double>& x) const {
+    const int W = BATCH_WIDTH;
+    auto n = f.front().size();
+    x.assign(n * W, 0.0);
+    for (unsigned int k = 0; k < f.size(); ++k) {
+      for (unsigned int j = 0; j < n; ++j) {
+	x[j*W + k] = f[k][j];
+      }
+    }
+  }
+
+  /** \brief Converts interleaved vectors to separate vectors
+   *
+   * \param x Interleaved vectors
+   * \param f Vectors of proper size, overwritten by lanes of \b x
+   */
+  void BatchLUSolver::unpack(const std::vector<double>& x, std::vector<std::vector<double> >& f) const {
+    const int W = BATCH_WIDTH;
+    for (unsigned int k = 0; k < f.size(); ++k) {
+      auto n = f[k].size();
+      for (unsigned int j = 0; j < n; ++j) {
+	f[k][j] = x[j*W + k];
+      }
+    }
+  }
+
+}  // namespace marian
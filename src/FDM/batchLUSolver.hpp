@@ -0,0 +1,65 @@
+#ifndef MARIAN_BATCHLUSOLVER_HPP
+#define MARIAN_BATCHLUSOLVER_HPP
+
+#include <vector>
+#include <FDM/tridiagonalOperator.hpp>
+
+namespace marian {
+
+  /** \ingroup fdm
+   * \brief Number of tridiagonal systems solved simultaneously by marian::BatchLUSolver
+   *
+   * Width is equal to the number of doubles held by SIMD register of the target instruction set:
+   * 8 for AVX-512, 4 for AVX/AVX2 and 2 for SSE2. To use wider registers the library should be compiled
+   * for the target architecture (e.g. with \b -march=native, see MARIAN_NATIVE_ARCH option in CMakeLists.txt).
+   */
+#if defined(__AVX512F__)
+  const int BATCH_WIDTH = 8;
+#elif defined(__AVX__)
+  const int BATCH_WIDTH = 4;
+#else
+  const int BATCH_WIDTH = 2;
+#endif
+
+  /** \ingroup fdm
+   * \brief Solver of many independent tridiagonal systems of the same size
+   *
+   * Solver handles up to marian::BATCH_WIDTH systems (lanes) at once. Matrices and right-hand sides are stored
+   * in structure-of-arrays layout, the i-th element of lane k is stored at position \f$i \times W + k\f$.
+   * LU method (see marian::LUSolver) is performed for all lanes simultaneously: the innermost loop runs over lanes,
+   * it has no dependencies between iterations and is vectorized by compiler, so a single SIMD instruction
+   * advances all lanes of the recursion.
+   *
+   * As marian::LUSolver, solver stores the factors of matrices, so the time stepping schemes factorize the matrices
+   * once per segment of constant time step and perform only substitutions in each step.
+   */
+  class BatchLUSolver {
+  public:
+    /** \brief Constructor
+     */
+    BatchLUSolver(): size_(0) {};
+
+    void factorize(const std::vector<TridiagonalOperator>& A);
+    bool isFactorized(const std::vector<TridiagonalOperator>& A) const;
+
+    void solveFactorized(std::vector<double>& x) const;
+    void solveFactorized(std::vector<std::vector<double> >& f);
+
+    void pack(const std::vector<std::vector<double> >& f, std::vector<double>& x) const;
+    void unpack(const std::vector<double>& x, std::vector<std::vector<double> >& f) const;
+
+    /** \brief Destructor
+     */
+    ~BatchLUSolver(){};
+  private:
+    std::vector<TridiagonalOperator> factorized_; /*!< \brief Matrices passed to factorize*/
+    std::vector<double> low_;    /*!< \brief Lower diagonals of factorized matrices (interleaved)*/
+    std::vector<double> gam_;    /*!< \brief Upper diagonals of U factors (interleaved)*/
+    std::vector<double> ibet_;   /*!< \brief Inverted pivots of U factors (interleaved)*/
+    std::vector<double> buffer_; /*!< \brief Interleaved right-hand sides*/
+    unsigned int size_;          /*!< \brief Size of systems*/
+  };
+
+}  // namespace marian
+
+#endif /* MARIAN_BATCHLUSOLVER_HPP */
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <FDM/tridiagonalOperator.hpp>
+#include <utils/dualNumber.hpp>
 
 namespace marian {
   /** \ingroup boundary
@@ -19,6 +20,10 @@ namespace marian {
    *
    * Class implements the boundary condition interface. It modifies tridiagonal operator and solution 
    * to ensure proper value of solution on boundaries.
+   *
+   * Methods are overloaded for all supported types of elements of operators (double, float and marian::Dual),
+   * so the same boundary conditions can be used by schemes working in any precision. Conditions do not implement
+   * the overloads directly, they derive from marian::DCBoundaryCondition and implement each hook once as a template.
    */
   class BoundaryCondition {    
   public:
@@ -33,6 +38,12 @@ namespace marian {
      * \param L Linear operator of PDE 
      */
     virtual void beforeExplicitStep(TridiagonalOperator& L) = 0;
+    /** \brief Modification of tridiagonal matrix of floats before explicit step (see beforeExplicitStep)
+     */
+    virtual void beforeExplicitStep(BasicTridiagonalOperator<float>& L) = 0;
+    /** \brief Modification of tridiagonal matrix of dual numbers before explicit step (see beforeExplicitStep)
+     */
+    virtual void beforeExplicitStep(BasicTridiagonalOperator<Dual>& L) = 0;
 
     /** \brief Modification of solution of after explicit step
      *
@@ -42,6 +53,12 @@ namespace marian {
      * \param t Actual time, passing time value enables using time-dependent boundary conditions 
      */
     virtual void afterExplicitStep(std::vector<double>& f, double t) = 0;
+    /** \brief Modification of solution of floats after explicit step (see afterExplicitStep)
+     */
+    virtual void afterExplicitStep(std::vector<float>& f, double t) = 0;
+    /** \brief Modification of solution of dual numbers after explicit step (see afterExplicitStep)
+     */
+    virtual void afterExplicitStep(std::vector<Dual>& f, double t) = 0;
 
     /** \brief Modification of tridiagonal matrix before equation f'=Lf is solved
      *
@@ -54,6 +71,16 @@ namespace marian {
     virtual void beforeImplicitStep(TridiagonalOperator& L,
 				    std::vector<double>& f,
 				    double t) = 0;
+    /** \brief Modification of tridiagonal matrix of floats before equation f'=Lf is solved (see beforeImplicitStep)
+     */
+    virtual void beforeImplicitStep(BasicTridiagonalOperator<float>& L,
+				    std::vector<float>& f,
+				    double t) = 0;
+    /** \brief Modification of tridiagonal matrix of dual numbers before equation f'=Lf is solved (see beforeImplicitStep)
+     */
+    virtual void beforeImplicitStep(BasicTridiagonalOperator<Dual>& L,
+				    std::vector<Dual>& f,
+				    double t) = 0;
 
     /** \brief Modification of solution of after solving equation f'=Lf is solved
      *
@@ -63,6 +90,31 @@ namespace marian {
      * \param t Actual time, passing time value enables using time-dependent boundary conditions 
      */
     virtual void afterImplicitStep(std::vector<double>& f,double t) = 0;
+    /** \brief Modification of solution of floats after solving equation f'=Lf is solved (see afterImplicitStep)
+     */
+    virtual void afterImplicitStep(std::vector<float>& f,double t) = 0;
+    /** \brief Modification of solution of dual numbers after solving equation f'=Lf is solved (see afterImplicitStep)
+     */
+    virtual void afterImplicitStep(std::vector<Dual>& f,double t) = 0;
+
+    /** \brief Checks if condition fixes the value of solution on one side of the grid (Dirichlet condition)
+     *
+     * Conditions fixing the value set the boundary row of operators to identity and the boundary element of solution
+     * to dirichletValue, so schemes with fused kernels can handle the boundary row inline instead of calling the hooks.
+     * Default implementation returns false.
+     *
+     * \param side Overwritten by the side of the grid if condition is Dirichlet condition
+     */
+    virtual bool isDirichlet(BCSide& side) const {
+      (void)side;
+      return false;
+    }
+    /** \brief Returns the value fixed on the boundary at time \b t (used only if isDirichlet returns true)
+     */
+    virtual double dirichletValue(double t) const {
+      (void)t;
+      return 0.0;
+    }
 
     /** \brief Returns the type of boundary condition
 	*
@@ -93,6 +145,11 @@ namespace marian {
    * The CRTP can be used to avoid having to duplicate that function or other similar functions in every derived class.
    *
    * For more information about virtual copy constructor see \cite joshi
+   *
+   * The same pattern implements the overloads of the hooks for all supported types of elements. They call templated members of
+   * derived class \b T (beforeExplicitStep, afterExplicitStep, beforeImplicitStep and afterImplicitStep taking
+   * BasicTridiagonalOperator<Real> and std::vector<Real>), so the condition implements each hook once for any type of elements.
+   * Hooks are called with explicit template arguments, so missing templated member is reported by the compiler.
    */
   template<typename T>
   class DCBoundaryCondition : public BoundaryCondition {
@@ -102,6 +159,52 @@ namespace marian {
     virtual BoundaryCondition* clone() const {
       return new T(static_cast<const T&>(*this));
     }
+
+    void beforeExplicitStep(TridiagonalOperator& L) override {
+      derived().template beforeExplicitStep<double>(L);
+    }
+    void beforeExplicitStep(BasicTridiagonalOperator<float>& L) override {
+      derived().template beforeExplicitStep<float>(L);
+    }
+    void beforeExplicitStep(BasicTridiagonalOperator<Dual>& L) override {
+      derived().template beforeExplicitStep<Dual>(L);
+    }
+
+    void afterExplicitStep(std::vector<double>& f, double t) override {
+      derived().template afterExplicitStep<double>(f, t);
+    }
+    void afterExplicitStep(std::vector<float>& f, double t) override {
+      derived().template afterExplicitStep<float>(f, t);
+    }
+    void afterExplicitStep(std::vector<Dual>& f, double t) override {
+      derived().template afterExplicitStep<Dual>(f, t);
+    }
+
+    void beforeImplicitStep(TridiagonalOperator& L, std::vector<double>& f, double t) override {
+      derived().template beforeImplicitStep<double>(L, f, t);
+    }
+    void beforeImplicitStep(BasicTridiagonalOperator<float>& L, std::vector<float>& f, double t) override {
+      derived().template beforeImplicitStep<float>(L, f, t);
+    }
+    void beforeImplicitStep(BasicTridiagonalOperator<Dual>& L, std::vector<Dual>& f, double t) override {
+      derived().template beforeImplicitStep<Dual>(L, f, t);
+    }
+
+    void afterImplicitStep(std::vector<double>& f, double t) override {
+      derived().template afterImplicitStep<double>(f, t);
+    }
+    void afterImplicitStep(std::vector<float>& f, double t) override {
+      derived().template afterImplicitStep<float>(f, t);
+    }
+    void afterImplicitStep(std::vector<Dual>& f, double t) override {
+      derived().template afterImplicitStep<Dual>(f, t);
+    }
+  private:
+    /** \brief Returns the condition as the derived class
+     */
+    T& derived() {
+      return static_cast<T&>(*this);
+    }
   };
 } // namespace marian
 
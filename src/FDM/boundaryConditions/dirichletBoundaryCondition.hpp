@@ -31,11 +31,56 @@ namespace marian {
     DirichletBoundaryCondition(BCSide side, F value):
       side_(side), value_(value) {};
 
-    void beforeExplicitStep(TridiagonalOperator&) override;
-    void afterExplicitStep(std::vector<double>&, double t) override;
+    /** \brief Modification of tridiagonal matrix before explicit step
+     *
+     * Elements of the first (in case of low boundary) or the last (in case of upper boundary) row of tridiagonal operator
+     * are set to 0.0, expect the diagonal element which is set to 1.0.
+     */
+    template<typename Real>
+    void beforeExplicitStep(BasicTridiagonalOperator<Real>& L) {
+      setRow(L);
+    }
 
-    void beforeImplicitStep(TridiagonalOperator&, std::vector<double>&, double t) override;
-    void afterImplicitStep(std::vector<double>&, double t) override;
+    /** \brief Modification of solution after explicit step
+     *
+     * The first (in case of low boundary) or the last (in case of upper boundary) element is set to certain value.
+     */
+    template<typename Real>
+    void afterExplicitStep(std::vector<Real>& f, double t) {
+      setValue(f, t);
+    }
+
+    /** \brief Modification of solution and linear operator before explicit step
+     *
+     * 
+     * Elements of the first (in case of low boundary) or the last (in case of upper boundary) row of tridiagonal operator
+     * are set to 0.0, expect the diagonal element which is set to 1.0.
+     *
+     * The first (in case of low boundary) or the last (in case of upper boundary) element is set to certain value.
+     */
+    template<typename Real>
+    void beforeImplicitStep(BasicTridiagonalOperator<Real>& L, std::vector<Real>& f, double t) {
+      setRow(L);
+      setValue(f, t);
+    }
+
+    /** \brief Empty method,  no modification performed
+     */
+    template<typename Real>
+    void afterImplicitStep(std::vector<Real>&, double) {
+    }
+
+    /** \brief Returns true for conditions set on lower or upper boundary
+     */
+    bool isDirichlet(BCSide& side) const override {
+      side = side_;
+      return side_ != BCSide::FREE;
+    }
+    /** \brief Returns the value on the boundary at time \b t
+     */
+    double dirichletValue(double t) const override {
+      return value_(t);
+    }
 
     std::string info() const override {
       std::string side;
@@ -51,81 +96,54 @@ namespace marian {
     virtual ~DirichletBoundaryCondition(){};
 
   private:
+    template<typename Real>
+    void setRow(BasicTridiagonalOperator<Real>& L) const;
+    template<typename Real>
+    void setValue(std::vector<Real>& f, double t);
+
     BCSide side_;    /*!< \brief Side for which boundary condition is set*/
     F value_;         /*!< \brief Value on the boundary.*/
   };
 
-  
-  /** \brief Modification of tridiagonal matrix before explicit step
+
+  /** \brief Sets the boundary row of tridiagonal operator
    *
    * Elements of the first (in case of low boundary) or the last (in case of upper boundary) row of tridiagonal operator
    * are set to 0.0, expect the diagonal element which is set to 1.0.
    */
   template<typename F>
-  void DirichletBoundaryCondition<F>::beforeExplicitStep(TridiagonalOperator& op) {
-    switch (side_) {
-    case BCSide::LOW:
-      op.setFirstRow(1.0, 0.0);
-      break;
-    case BCSide::UPP:
-      op.setLastRow(0.0, 1.0);
-      break;
-    case BCSide::FREE:
-      break;
-    }
-  }
-
-  /** \brief Modification of solution after explicit step
-   *
-   * The first (in case of low boundary) or the last (in case of upper boundary) element is set to certain value.
-   */
-  template<typename F>
-  void DirichletBoundaryCondition<F>::afterExplicitStep(std::vector<double>& f, double t) {
+  template<typename Real>
+  void DirichletBoundaryCondition<F>::setRow(BasicTridiagonalOperator<Real>& L) const {
     switch (side_) {
     case BCSide::LOW:
-      f.front() = value_(t);
+      L.setFirstRow(1.0, 0.0);
       break;
     case BCSide::UPP:
-      f.back() = value_(t);
+      L.setLastRow(0.0, 1.0);
       break;
     case BCSide::FREE:
       break;
     }
   }
 
-  /** \brief Modification of solution and linear operator before explicit step
-   *
-   * 
-   * Elements of the first (in case of low boundary) or the last (in case of upper boundary) row of tridiagonal operator
-   * are set to 0.0, expect the diagonal element which is set to 1.0.
+  /** \brief Sets the boundary value of solution
    *
    * The first (in case of low boundary) or the last (in case of upper boundary) element is set to certain value.
    */
   template<typename F>
-  void DirichletBoundaryCondition<F>::beforeImplicitStep(TridiagonalOperator& L,
-							 std::vector<double>& f,
-							 double t) {
+  template<typename Real>
+  void DirichletBoundaryCondition<F>::setValue(std::vector<Real>& f, double t) {
     switch (side_) {
     case BCSide::LOW:
-      L.setFirstRow(1.0, 0.0);
       f.front() = value_(t);
       break;
     case BCSide::UPP:
-      L.setLastRow(0.0, 1.0);
       f.back() = value_(t);
       break;
     case BCSide::FREE:
       break;
     }
   }
-
-  /** \brief Empty method,  no modification performed
-   *
-   *  
-   */
-  template<typename F>
-  void DirichletBoundaryCondition<F>::afterImplicitStep(std::vector<double>&, double) {
-  }
   
 } // namespace marian
 
@@ -0,0 +1,105 @@
+#include <FDM/compactDiscretization.hpp>
+#include <utils/dualNumber.hpp>
+
+namespace marian {
+
+  /** \ingroup fdm
+   * \brief Fourth order compact discretization of convection-diffusion operator
+   *
+   * Equation \f$\frac{\partial u}{\partial t} = a \frac{\partial^2 u}{\partial x^2} + b \frac{\partial u}{\partial x} + c u\f$
+   * is discretized in the form \f$M \frac{du}{dt} = K u\f$ with tridiagonal matrices \f$M\f$ and \f$K\f$
+   * (high order compact scheme \cite MortonMayers).
+   *
+   * Grid is treated as the image of uniform grid \f$\xi_i = i\f$ by smooth mapping \f$x(\xi)\f$ (uniform grid, marian::HSineGridBuilder).
+   * In variable \f$\xi\f$ the operator has variable coefficients \f$A u_{\xi\xi} + B u_\xi\f$,
+   * \f$A = a / x'^2\f$, \f$B = b / x' - a x'' / x'^3\f$, where derivatives of the mapping are calculated from the nodes
+   * by five point formulas of fourth order. Truncation error of three point formulas \f$\delta^2 u\f$ and \f$\delta_0 u\f$ contains
+   * \f$u'''\f$ and \f$u''''\f$, which are expressed by derivatives of the equation \f$A u'' + B u' = G\f$, \f$G = u_t - c u\f$:
+   * \f[ \Big(A + \frac{P}{12}\Big) \delta^2 u + \Big(B + \frac{Q}{12}\Big) \delta_0 u = \Big(I + \frac{1}{12}\delta^2 + \frac{R}{12}\delta_0\Big) G + O(h^4) \f]
+   * \f[ P = A'' + 2B' + \frac{(B - 2A')(A' + B)}{A}, \qquad Q = B'' + \frac{(B - 2A')B'}{A}, \qquad R = \frac{B - 2A'}{A} \f]
+   * (derivatives of coefficients are calculated by central differences, they appear only in the terms of order \f$h^2\f$).
+   * Hence \f$M = I + \frac{1}{12}\delta^2 + \frac{R}{12}\delta_0\f$ and
+   * \f$K = (A + \frac{P}{12}) \delta^2 + (B + \frac{Q}{12}) \delta_0 + c M\f$.
+   *
+   * Boundary rows of \f$M\f$ are rows of identity and boundary rows of \f$K\f$ are the same as in the operator built from
+   * TridiagonalOperator::DZero and TridiagonalOperator::DPlusMinus, they are meant to be replaced by boundary conditions.
+   * Grids with less than five nodes are discretized with second order operators (\f$M = I\f$).
+   *
+   * \param grid Grid used for discretization (uniform or smoothly mapped)
+   * \param a Coefficient of the second derivative
+   * \param b Coefficient of the first derivative
+   * \param c Coefficient of the function
+   * \param M Overwritten by mass matrix
+   * \param K Overwritten by stiffness matrix
+   */
+  template<typename Real>
+  void compactDiscretization(const std::vector<double>& grid,
+			     Real a,
+			     Real b,
+			     Real c,
+			     BasicTridiagonalOperator<Real>& M,
+			     BasicTridiagonalOperator<Real>& K) {
+    unsigned int n = grid.size();
+    M = BasicTridiagonalOperator<Real>::I(grid);
+    if (n < 5) {
+      K = a * BasicTridiagonalOperator<Real>::DPlusMinus(grid) + b * BasicTridiagonalOperator<Real>::DZero(grid)
+	+ c * BasicTridiagonalOperator<Real>::I(grid);
+      return;
+    }
+
+    // derivatives of mapping, one-sided formulas at two nodes near each end
+    std::vector<double> dx(n);
+    std::vector<double> ddx(n);
+    for (unsigned int i = 2; i < n - 2; ++i) {
+      dx[i] = (grid[i-2] - 8.0 * grid[i-1] + 8.0 * grid[i+1] - grid[i+2]) / 12.0;
+      ddx[i] = (-grid[i-2] + 16.0 * grid[i-1] - 30.0 * grid[i] + 16.0 * grid[i+1] - grid[i+2]) / 12.0;
+    }
+    for (int side = 0; side < 2; ++side) {
+      double sign = side == 0 ? 1.0 : -1.0;
+      auto x = [&](unsigned int k) { return side == 0 ? grid[k] : grid[n-1-k]; };
+      unsigned int first = side == 0 ? 0 : n - 1;
+      unsigned int second = side == 0 ? 1 : n - 2;
+      dx[first] = sign * (-25.0 * x(0) + 48.0 * x(1) - 36.0 * x(2) + 16.0 * x(3) - 3.0 * x(4)) / 12.0;
+      dx[second] = sign * (-3.0 * x(0) - 10.0 * x(1) + 18.0 * x(2) - 6.0 * x(3) + x(4)) / 12.0;
+      ddx[first] = (35.0 * x(0) - 104.0 * x(1) + 114.0 * x(2) - 56.0 * x(3) + 11.0 * x(4)) / 12.0;
+      ddx[second] = (11.0 * x(0) - 20.0 * x(1) + 6.0 * x(2) + 4.0 * x(3) - x(4)) / 12.0;
+    }
+
+    std::vector<Real> A(n);
+    std::vector<Real> B(n);
+    for (unsigned int i = 0; i < n; ++i) {
+      A[i] = a / (dx[i] * dx[i]);
+      B[i] = b / dx[i] - a * (ddx[i] / (dx[i] * dx[i] * dx[i]));
+    }
+
+    K = BasicTridiagonalOperator<Real>(n);
+    Real boundary = a + b + c;
+    K.setFirstRow(boundary, 0.0);
+    for (unsigned int i = 1; i < n - 1; ++i) {
+      Real dA = 0.5 * (A[i+1] - A[i-1]);
+      Real ddA = A[i+1] - 2.0 * A[i] + A[i-1];
+      Real dB = 0.5 * (B[i+1] - B[i-1]);
+      Real ddB = B[i+1] - 2.0 * B[i] + B[i-1];
+      Real R = (B[i] - 2.0 * dA) / A[i];
+      Real P = ddA + 2.0 * dB + R * (dA + B[i]);
+      Real Q = ddB + R * dB;
+      Real second = A[i] + P / 12.0;
+      Real first = B[i] + Q / 12.0;
+
+      Real m_low = 1.0 / 12.0 - R / 24.0;
+      Real m_mid = 10.0 / 12.0;
+      Real m_upp = 1.0 / 12.0 + R / 24.0;
+      M.setMidRow(i + 1, m_low, m_mid, m_upp);
+      K.setMidRow(i + 1, second - 0.5 * first + c * m_low, -2.0 * second + c * m_mid, second + 0.5 * first + c * m_upp);
+    }
+    K.setLastRow(0.0, boundary);
+  }
+
+  // instantiations for supported types of elements
+  template void compactDiscretization<double>(const std::vector<double>&, double, double, double,
+					      BasicTridiagonalOperator<double>&, BasicTridiagonalOperator<double>&);
+  template void compactDiscretization<float>(const std::vector<double>&, float, float, float,
+					     BasicTridiagonalOperator<float>&, BasicTridiagonalOperator<float>&);
+  template void compactDiscretization<Dual>(const std::vector<double>&, Dual, Dual, Dual,
+					    BasicTridiagonalOperator<Dual>&, BasicTridiagonalOperator<Dual>&);
+}  // namespace marian
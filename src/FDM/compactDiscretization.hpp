@@ -0,0 +1,19 @@
+#ifndef MARIAN_COMPACTDISCRETIZATION_HPP
+#define MARIAN_COMPACTDISCRETIZATION_HPP
+
+#include <vector>
+#include <FDM/tridiagonalOperator.hpp>
+
+namespace marian {
+
+  template<typename Real>
+  void compactDiscretization(const std::vector<double>& grid,
+			     Real a,
+			     Real b,
+			     Real c,
+			     BasicTridiagonalOperator<Real>& M,
+			     BasicTridiagonalOperator<Real>& K);
+
+}  // namespace marian
+
+#endif /* MARIAN_COMPACTDISCRETIZATION_HPP */
@@ -13,7 +13,7 @@ namespace marian {
   std::vector<double> HSineGridBuilder::buildGrid(double low, double upp, int N, double concentration) const {
     std::vector<double> grid(N);
     double K = (concentration - low) / (upp - low);
-    double dx = (1.0 / N) * (std::asinh((1.0 - K) / c_) - std::asinh(-K / c_));
+    double dx = (1.0 / (N - 1)) * (std::asinh((1.0 - K) / c_) - std::asinh(-K / c_));
     double mid = std::asinh(-K / c_);
     for (int i = 0; i < N-1; ++i) {
       grid.at(i) = low + (K + c_ * std::sinh(mid + i * dx)) * (upp - low);
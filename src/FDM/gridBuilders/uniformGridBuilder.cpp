@@ -14,7 +14,7 @@ namespace marian {
     std::vector<double> grid(N);
     double spacing  = (upp - low) / (N-1);
     grid.at(0) = low;
-    for (int i = 0; i < N; i++ ) {
+    for (int i = 0; i < N-1; i++ ) {
       grid[i+1] = (grid.at(i) + spacing);
     }
     return grid;
@@ -0,0 +1,158 @@
+#include <FDM/partitionedSolver.hpp>
+#include <utils/dualNumber.hpp>
+#include <algorithm>
+
+namespace marian {
+
+  /** \brief Method solves tridiagonal system using partition method
+   *
+   * \param A Tridiagonal matrix defining tridiagonal system
+   * \param w Vector of real numbers
+   * \return Vector of real numbers being solution of system: \f$w = A \times v\f$
+   */
+  template<typename Real>
+  std::vector<Real> BasicPartitionedSolver<Real>::solve(const BasicTridiagonalOperator<Real>& A,
+							const std::vector<Real>& w) const {
+    BasicPartitionedSolver solver(threads_);
+    solver.factorize(A);
+    return solver.solveFactorized(w);
+  }
+
+  /** \brief Divides the system into blocks and computes LU factors and spikes of blocks and LU factors of reduced system
+   *
+   * \param A Tridiagonal matrix defining tridiagonal system
+   */
+  template<typename Real>
+  void BasicPartitionedSolver<Real>::factorize(const BasicTridiagonalOperator<Real>& A) {
+    BasicTridiagonalSolver<Real>::factorize(A);
+    unsigned int size = A.size();
+    unsigned int blocks = std::max(1u, std::min(threads_, (size + 1) / (MIN_BLOCK + 1)));
+
+    // block k occupies rows [begin_[k], begin_[k+1] - 1), row begin_[k+1] - 1 is separator (or end of system for the last block)
+    unsigned int rows = size - (blocks - 1);
+    begin_.resize(blocks + 1);
+    begin_[0] = 0;
+    for (unsigned int k = 0; k < blocks; ++k) {
+      begin_[k+1] = begin_[k] + rows / blocks + (k < rows % blocks ? 1 : 0) + 1;
+    }
+
+    low_.assign(size, Real(0.0));
+    gam_.assign(size, Real(0.0));
+    ibet_.assign(size, Real(0.0));
+    alpha_.assign(size, Real(0.0));
+    beta_.assign(size, Real(0.0));
+
+    pool_.run(blocks, [&](unsigned int k) {
+	unsigned int s = begin_[k];
+	unsigned int e = begin_[k+1] - 1;
+
+	ibet_[s] = 1.0 / A.mid(s);
+	for (unsigned int i = s + 1; i < e; ++i) {
+	  low_[i] = A.low(i-1);
+	  gam_[i] = A.upp(i-1) * ibet_[i-1];
+	  ibet_[i] = 1.0 / (A.mid(i) - low_[i] * gam_[i]);
+	}
+
+	if (k > 0) {
+	  alpha_[s] = -A.low(s-1) * ibet_[s];
+	  for (unsigned int i = s + 1; i < e; ++i) {
+	    alpha_[i] = -low_[i] * alpha_[i-1] * ibet_[i];
+	  }
+	  for (unsigned int i = e - 1; i > s; --i) {
+	    alpha_[i-1] -= gam_[i] * alpha_[i];
+	  }
+	}
+
+	if (k + 1 < blocks) {
+	  beta_[e-1] = -A.upp(e-1) * ibet_[e-1];
+	  for (unsigned int i = e - 1; i > s; --i) {
+	    beta_[i-1] = -gam_[i] * beta_[i];
+	  }
+	}
+      });
+
+    unsigned int seps = blocks - 1;
+    red_low_.assign(seps, Real(0.0));
+    red_gam_.assign(seps, Real(0.0));
+    red_ibet_.assign(seps, Real(0.0));
+    red_v_.assign(seps, Real(0.0));
+    Real upp = 0.0;
+    for (unsigned int k = 0; k < seps; ++k) {
+      unsigned int j = begin_[k+1] - 1;
+      Real a = A.low(j-1);
+      Real c = A.upp(j);
+      Real mid = A.mid(j) + a * beta_[j-1] + c * alpha_[j+1];
+      if (k > 0) {
+	red_low_[k] = a * alpha_[j-1];
+	red_gam_[k] = upp * red_ibet_[k-1];
+      }
+      red_ibet_[k] = 1.0 / (mid - red_low_[k] * red_gam_[k]);
+      upp = c * beta_[j+1];
+    }
+  }
+
+  /** \brief Solves tridiagonal system using factors computed by factorize
+   *
+   * \param w Vector of real numbers
+   * \return Vector of real numbers being solution of system: \f$w = A \times v\f$
+   */
+  template<typename Real>
+  std::vector<Real> BasicPartitionedSolver<Real>::solveFactorized(const std::vector<Real>& w) const {
+    std::vector<Real> ret(ibet_.size());
+    solveFactorized(w, ret);
+    return ret;
+  }
+
+  /** \brief Solves tridiagonal system using factors computed by factorize writing the solution to provided vector
+   *
+   * Blocks are solved in parallel, then reduced system is solved and the spikes are added in parallel.
+   * Vectors \b w and \b v may be the same vector.
+   *
+   * \param w Vector of real numbers
+   * \param v Vector of size equal to size of factorized matrix, overwritten by solution of system: \f$w = A \times v\f$
+   */
+  template<typename Real>
+  void BasicPartitionedSolver<Real>::solveFactorized(const std::vector<Real>& w, std::vector<Real>& v) const {
+    unsigned int blocks = begin_.size() - 1;
+
+    pool_.run(blocks, [&](unsigned int k) {
+	unsigned int s = begin_[k];
+	unsigned int e = begin_[k+1] - 1;
+	v[s] = w[s] * ibet_[s];
+	for (unsigned int i = s + 1; i < e; ++i) {
+	  v[i] = (w[i] - low_[i] * v[i-1]) * ibet_[i];
+	}
+	for (unsigned int i = e - 1; i > s; --i) {
+	  v[i-1] -= gam_[i] * v[i];
+	}
+      });
+
+    unsigned int seps = blocks - 1;
+    for (unsigned int k = 0; k < seps; ++k) {
+      unsigned int j = begin_[k+1] - 1;
+      Real rhs = w[j] - this->factorized_.low(j-1) * v[j-1] - this->factorized_.upp(j) * v[j+1];
+      red_v_[k] = (k > 0 ? rhs - red_low_[k] * red_v_[k-1] : rhs) * red_ibet_[k];
+    }
+    for (unsigned int k = seps; k > 1; --k) {
+      red_v_[k-2] -= red_gam_[k-1] * red_v_[k-1];
+    }
+
+    pool_.run(blocks, [&](unsigned int k) {
+	unsigned int s = begin_[k];
+	unsigned int e = begin_[k+1] - 1;
+	Real left = k > 0 ? red_v_[k-1] : Real(0.0);
+	Real right = k < seps ? red_v_[k] : Real(0.0);
+	for (unsigned int i = s; i < e; ++i) {
+	  v[i] += alpha_[i] * left + beta_[i] * right;
+	}
+	if (k < seps) {
+	  v[e] = right;
+	}
+      });
+  }
+
+  // instantiations for supported types of elements
+  template class BasicPartitionedSolver<double>;
+  template class BasicPartitionedSolver<float>;
+  template class BasicPartitionedSolver<Dual>;
+}  // namespace marian
@@ -0,0 +1,74 @@
+#ifndef MARIAN_PARTITIONEDSOLVER_HPP
+#define MARIAN_PARTITIONEDSOLVER_HPP
+
+#include <thread>
+#include <FDM/tridiagonalSolver.hpp>
+#include <utils/parallel.hpp>
+
+namespace marian {
+  /** \ingroup fdm
+   * \brief Method applying implicit step, solving single large system on many threads
+   *
+   * Solver implements partition method (similar to SPIKE algorithm). Rows of the system are divided into \f$p\f$ blocks
+   * separated by single rows (separators). Solution inside block \f$k\f$ depends only on the values at neighbouring separators:
+   * \f[ v_i = y_i + \alpha_i v_{s_{k-1}} + \beta_i v_{s_k}, \f]
+   * where \f$y\f$ solves block system with the right-hand side \f$w\f$, and spikes \f$\alpha\f$, \f$\beta\f$ solve block system
+   * with the right-hand side equal to the coupling with left and right separator. Inserting the formula into the rows of separators
+   * gives tridiagonal system of size \f$p-1\f$ (reduced system).
+   *
+   * In factorize, LU factors of the blocks, spikes and LU factors of the reduced system are computed (blocks in parallel).
+   * In solveFactorized each thread performs LU substitution on its block, the reduced system is solved by the calling thread
+   * and finally each thread adds the spikes multiplied by the values at separators.
+   * Substitution performs about 30% more operations than marian::LUSolver, but the work is divided equally between the threads.
+   *
+   * Blocks are factorized without pivoting, so solver should be used for diagonally dominant systems
+   * (like the ones produced by implicit and Crank-Nicolson schemes).
+   * Blocks are processed by persistent threads of marian::WorkerPool, started by the first factorization and reused by all solves,
+   * so each solve costs two passes of barriers instead of starting threads. Solver pays off for grids of \f$10^5\f$ nodes and more.
+   * For smaller grids number of blocks is reduced, so every block has at least MIN_BLOCK rows.
+   */
+  template<typename Real>
+  class BasicPartitionedSolver : public DCTridiagonalSolver<BasicPartitionedSolver<Real>, Real> {
+  public:
+    /** \brief Constructor
+     *
+     * \param threads Number of threads (blocks) used by solver, by default number of hardware threads
+     */
+    explicit BasicPartitionedSolver(unsigned int threads = std::thread::hardware_concurrency()):
+      threads_(threads > 0 ? threads : 1) {};
+
+    virtual std::vector<Real> solve(const BasicTridiagonalOperator<Real>& A,
+				    const std::vector<Real>& w) const override;
+
+    void factorize(const BasicTridiagonalOperator<Real>& A) override;
+    std::vector<Real> solveFactorized(const std::vector<Real>& w) const override;
+    void solveFactorized(const std::vector<Real>& w, std::vector<Real>& v) const override;
+
+    /** \brief Destructor
+     */
+    ~BasicPartitionedSolver(){};
+  private:
+    static const unsigned int MIN_BLOCK = 4096; /*!< \brief Minimal number of rows in block*/
+
+    unsigned int threads_;            /*!< \brief Maximal number of threads*/
+    std::vector<unsigned int> begin_; /*!< \brief First row of each block, block k ends at separator begin_[k+1]-1*/
+    std::vector<Real> low_;           /*!< \brief Lower diagonal of factorized blocks*/
+    std::vector<Real> gam_;           /*!< \brief Upper diagonals of U factors of blocks*/
+    std::vector<Real> ibet_;          /*!< \brief Inverted pivots of U factors of blocks*/
+    std::vector<Real> alpha_;         /*!< \brief Spikes coupling rows of blocks with left separators*/
+    std::vector<Real> beta_;          /*!< \brief Spikes coupling rows of blocks with right separators*/
+    std::vector<Real> red_low_;       /*!< \brief Lower diagonal of reduced system*/
+    std::vector<Real> red_gam_;       /*!< \brief Upper diagonal of U factor of reduced system*/
+    std::vector<Real> red_ibet_;      /*!< \brief Inverted pivots of U factor of reduced system*/
+    mutable std::vector<Real> red_v_; /*!< \brief Values at separators*/
+    mutable WorkerPool pool_;         /*!< \brief Threads processing the blocks*/
+  };
+
+  /** \ingroup fdm
+   * \brief Partitioned solver of systems of doubles
+   */
+  typedef BasicPartitionedSolver<double> PartitionedSolver;
+
+}  // namespace marian
+
+#endif /* MARIAN_PARTITIONEDSOLVER_HPP */
@@ -0,0 +1,124 @@
+#include <FDM/schemes/adaptiveScheme.hpp>
+#include <algorithm>
+#include <utils/dataFrame.hpp>
+
+namespace marian {
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * PDE is solved from the first to the last point of time grid with steps chosen by local error control.
+   * Time grid may be decreasing (as time grids of backward equations are).
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid, its first step is the initial trial step
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> AdaptiveScheme::solve(std::vector<double> f,
+					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					    const std::vector<double>& time_grid,
+					    const TridiagonalOperator& L) {
+    double end = time_grid.back();
+    double direction = end > time_grid.front() ? 1.0 : -1.0;
+    double min_dt = MIN_STEP * std::fabs(end - time_grid.front());
+    double dt = std::fabs(time_grid.at(1) - time_grid.front());
+    accepted_.assign(1, time_grid.front());
+    rejected_ = 0;
+    while (direction * (end - accepted_.back()) > min_dt) {
+      dt = step(f, bcs, accepted_.back(), direction * std::min(dt, direction * (end - accepted_.back())), min_dt, L);
+    }
+    return f;
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
+   *
+   * Solution is saved on accepted time levels.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Time grid, its first step is the initial trial step
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> AdaptiveScheme::solveAndSave(std::vector<double> f,
+						   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						   const std::vector<double>& spatial_grid,
+						   const std::vector<double>& time_grid,
+						   const TridiagonalOperator& L,
+						   const std::string file_name) {
+    DataFrame df;
+    for (unsigned int i = 0; i < f.size(); i++) {
+      DataEntryClerk input;
+      input.add("T", time_grid.front());
+      input.add("S", spatial_grid.at(i));
+      input.add("f", f.at(i));
+      df.append(input);
+    }
+
+    double end = time_grid.back();
+    double direction = end > time_grid.front() ? 1.0 : -1.0;
+    double min_dt = MIN_STEP * std::fabs(end - time_grid.front());
+    double dt = std::fabs(time_grid.at(1) - time_grid.front());
+    accepted_.assign(1, time_grid.front());
+    rejected_ = 0;
+    while (direction * (end - accepted_.back()) > min_dt) {
+      dt = step(f, bcs, accepted_.back(), direction * std::min(dt, direction * (end - accepted_.back())), min_dt, L);
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", accepted_.back());
+	input.add("S", spatial_grid.at(j));
+	input.add("f", f.at(j));
+	df.append(input);
+      }
+    }
+    df.printToCsv(file_name,';');
+    return f;
+  }
+
+  /** \brief Performs single accepted time step
+   *
+   * Trial steps are repeated with reduced length until the estimated local error is below tolerance.
+   * Steps shorter than \b min_dt are accepted regardless of the error.
+   * Trial solution is kept in internal buffer, so the rejected step does not modify the solution.
+   *
+   * \param f Solution, overwritten by solution on the next accepted time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Trial time step (negative when PDE is solved backward in time)
+   * \param min_dt Minimal length of time step
+   * \param L Linear operator defining PDE
+   * \returns Proposed length of the next step
+   */
+  double AdaptiveScheme::step(std::vector<double>& f,
+			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			      double t,
+			      double dt,
+			      double min_dt,
+			      const TridiagonalOperator& L) {
+    while (true) {
+      trial_ = f;
+      double err = scheme_->stepWithError(trial_, bcs, t, dt, L);
+      double factor = err > 0.0 ? 0.9 * std::pow(tolerance_ / err, 1.0 / (order_ + 1.0)) : 5.0;
+      factor = std::min(5.0, std::max(0.2, factor));
+      if (factor >= 1.0 && factor < 1.5) {
+	// small growth is not worth assembling and factorizing operators of new step
+	factor = 1.0;
+      }
+
+      if (err <= tolerance_ || std::fabs(dt) <= min_dt) {
+	if (err > tolerance_) {
+	  std::cout << "AdaptiveScheme: minimal time step reached, local error " << err << " exceeds tolerance" << std::endl;
+	}
+	f.swap(trial_);
+	accepted_.push_back(t + dt);
+	return std::fabs(dt) * factor;
+      }
+      rejected_++;
+      dt *= factor;
+    }
+  }
+
+}  // namespace marian
@@ -0,0 +1,90 @@
+#ifndef MARIAN_ADAPTIVESCHEME_HPP
+#define MARIAN_ADAPTIVESCHEME_HPP
+
+#include <FDM/schemes/fdScheme.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements driver choosing time steps of scheme with local error control
+   *
+   * Each trial step \f$dt\f$ is performed once by the wrapped scheme, which estimates its local error \f$err\f$
+   * with embedded error estimate (see FDScheme::stepWithError, provided e.g. by marian::BasicTRBDF2Scheme).
+   * Step is accepted if \f$err \le tol\f$, otherwise it is repeated with smaller step.
+   * Next step is scaled by \f$0.9 (tol/err)^{1/(p+1)}\f$ (factor limited to [0.2, 5]), where \f$p\f$ is the order of the scheme.
+   * Factors in [1, 1.5) keep the step unchanged, so the scheme reuses the operators and their factorization.
+   *
+   * Only the first and the last point of provided time grid are used, the first step of the grid is the initial trial step.
+   * Local error is controlled, not the error at the final time. If coefficients and boundary conditions do not depend
+   * on time, local error of each step propagated to the final time has the same size, so uniform time grid is optimal
+   * and short steps chosen near the payoff date only add steps. Driver pays off for features localized in time,
+   * e.g. boundary conditions or coefficients changing quickly within short period.
+   * Accepted time grid and the number of rejected steps of the last solve are available by getTimeGrid and getRejectedSteps.
+   *
+   * Accepted step costs one step of the scheme with small overhead of the estimate (one multiplication and one solve
+   * with the factorization of the step for TR-BDF2 scheme). Scheme keeps the operators assembled for the last step,
+   * so the operators are assembled and factorized again only when the step length changes.
+   * See adaptiveTimeSteppingExample.cpp for comparison with uniform time grids.
+   */
+  class AdaptiveScheme : public DCFDScheme<AdaptiveScheme> {
+  public:
+    /** \brief Constructor
+     *
+     * \param scheme Scheme performing time steps, it has to provide embedded error estimate (see FDScheme::stepWithError)
+     * \param tolerance Maximal local error of time step
+     * \param order Order of scheme in time (2 for TR-BDF2 scheme)
+     */
+    AdaptiveScheme(SmartPointer<FDScheme> scheme,
+		   double tolerance = 1e-6,
+		   unsigned int order = 2):
+      scheme_(scheme), tolerance_(tolerance), order_(order) {};
+
+    /** \brief Provides a solver used by scheme performing time steps
+     */
+    void setSolver(const SmartPointer<TridiagonalSolver>& solver) override {
+      scheme_->setSolver(solver);
+    }
+    std::vector<double> solve(std::vector<double> f,
+			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			      const std::vector<double>& time_grid,
+			      const TridiagonalOperator& L) override;
+    std::vector<double> solveAndSave(std::vector<double> f,
+				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				     const std::vector<double>& spatial_grid,
+				     const std::vector<double>& time_grid,
+				     const TridiagonalOperator& L,
+				     const std::string file_name) override;
+    std::string info() const override {
+      return "Adaptive " + scheme_->info();
+    }
+
+    /** \brief Returns time points of accepted steps of the last solve (including initial time)
+     */
+    const std::vector<double>& getTimeGrid() const {
+      return accepted_;
+    }
+    /** \brief Returns number of steps rejected in the last solve
+     */
+    unsigned int getRejectedSteps() const {
+      return rejected_;
+    }
+  private:
+    double step(std::vector<double>& f,
+		const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+		double t,
+		double dt,
+		double min_dt,
+		const TridiagonalOperator& L);
+
+    static constexpr double MIN_STEP = 1e-8; /*!< \brief Minimal time step relative to length of time grid*/
+
+    SmartPointer<FDScheme> scheme_;   /*!< \brief Scheme performing time steps*/
+    double tolerance_;                /*!< \brief Maximal local error of time step*/
+    unsigned int order_;              /*!< \brief Order of scheme in time*/
+    std::vector<double> accepted_;    /*!< \brief Time points of accepted steps of the last solve*/
+    std::vector<double> trial_;       /*!< \brief Solution of the trial step*/
+    unsigned int rejected_ = 0;       /*!< \brief Number of steps rejected in the last solve*/
+  };
+
+} // namespace marian
+
+#endif /* MARIAN_ADAPTIVESCHEME_HPP */
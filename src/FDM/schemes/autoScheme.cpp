@@ -0,0 +1,196 @@
+#include <FDM/schemes/autoScheme.hpp>
+#include <FDM/schemes/explicitScheme.hpp>
+#include <FDM/schemes/implicitScheme.hpp>
+#include <FDM/schemes/crankNicolsonScheme.hpp>
+#include <FDM/schemes/trBDF2Scheme.hpp>
+#include <utils/dualNumber.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace marian {
+
+  /** \brief Solves PDE with the scheme chosen for provided operator and time grid
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicAutoScheme<Real>::solve(std::vector<Real> f,
+						 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						 const std::vector<double>& time_grid,
+						 const BasicTridiagonalOperator<Real>& L) {
+    choose(time_grid, L);
+    return scheme_->solve(f, bcs, time_grid, L);
+  }
+
+  /** \brief Solves PDE with the scheme chosen for provided operator and time grid, keeping the solution on the next-to-last time level
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param previous Overwritten by solution on the next-to-last time level
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicAutoScheme<Real>::solveWithPrevious(std::vector<Real> f,
+							     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							     const std::vector<double>& time_grid,
+							     const BasicTridiagonalOperator<Real>& L,
+							     std::vector<Real>& previous) {
+    choose(time_grid, L);
+    return scheme_->solveWithPrevious(f, bcs, time_grid, L, previous);
+  }
+
+  /** \brief Solves PDE with the scheme chosen for provided operator and time grid. Additionally saves solution to CSV file
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Time grid used for time dimension of FDM
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicAutoScheme<Real>::solveAndSave(std::vector<Real> f,
+							const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							const std::vector<double>& spatial_grid,
+							const std::vector<double>& time_grid,
+							const BasicTridiagonalOperator<Real>& L,
+							const std::string file_name) {
+    choose(time_grid, L);
+    return scheme_->solveAndSave(f, bcs, spatial_grid, time_grid, L, file_name);
+  }
+
+  /** \brief Solves PDE for many initial conditions with the scheme chosen for provided operator and time grid
+   *
+   * \param f Initial conditions, one vector (column) for each problem
+   * \param bcs Boundary conditions, one set for each problem
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solutions, one vector for each problem
+   */
+  template<typename Real>
+  std::vector<std::vector<Real> > BasicAutoScheme<Real>::solveMany(std::vector<std::vector<Real> > f,
+								   const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+								   const std::vector<double>& time_grid,
+								   const BasicTridiagonalOperator<Real>& L) {
+    choose(time_grid, L);
+    return scheme_->solveMany(f, bcs, time_grid, L);
+  }
+
+  /** \brief Solves PDE in adjoint mode with the scheme chosen for provided operator and time grid
+   *
+   * Only schemes supporting adjoint mode are chosen (see the class description).
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param w Weights defining functional of the final solution
+   * \param dL Overwritten by derivatives of functional with respect to elements of \b L
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicAutoScheme<Real>::solveAdjoint(std::vector<Real> f,
+							const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							const std::vector<double>& time_grid,
+							const BasicTridiagonalOperator<Real>& L,
+							const std::vector<Real>& w,
+							BasicTridiagonalOperator<Real>& dL) {
+    choose(time_grid, L, true);
+    return scheme_->solveAdjoint(f, bcs, time_grid, L, w, dL);
+  }
+
+  /** \brief Chooses the scheme for provided operator and time grid
+   *
+   * Step of the largest length decides, because coefficients of \f$I + dt L\f$ have the same signs for all steps
+   * of monotone time grid and the diagonal is the smallest for the largest step.
+   * Scheme is created only when the choice changes, so the scheme reused in many solves keeps its state
+   * (e.g. factorizations of Crank-Nicolson scheme).
+   *
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param adjoint True if the scheme has to support adjoint mode
+   */
+  template<typename Real>
+  void BasicAutoScheme<Real>::choose(const std::vector<double>& time_grid, const BasicTridiagonalOperator<Real>& L, bool adjoint) {
+    double dt = 0.0;
+    for (unsigned int i = 0; i + 1 < time_grid.size(); i++) {
+      double step = time_grid.at(i+1) - time_grid.at(i);
+      if (std::fabs(step) > std::fabs(dt)) {
+	dt = step;
+      }
+    }
+
+    int size = L.size();
+    double radius = 0.0;
+    bool monotone = true;
+    for (int i = 0; i < size; i++) {
+      double mid = static_cast<double>(L.mid(i));
+      double row = std::fabs(mid);
+      monotone = monotone && 1.0 + dt * mid >= 0.0;
+      if (i > 0) {
+	double low = static_cast<double>(L.low(i-1));
+	row += std::fabs(low);
+	monotone = monotone && dt * low >= 0.0;
+      }
+      if (i < size - 1) {
+	double upp = static_cast<double>(L.upp(i));
+	row += std::fabs(upp);
+	monotone = monotone && dt * upp >= 0.0;
+      }
+      radius = std::max(radius, row);
+    }
+    double z = std::fabs(dt) * radius;
+
+    Choice choice;
+    std::string reason;
+    if (mass_.size() > 0) {
+      choice = Choice::CRANK_NICOLSON;
+      reason = "mass matrix is supported only by Crank-Nicolson scheme";
+    } else if (monotone) {
+      choice = adjoint ? Choice::CRANK_NICOLSON : Choice::EXPLICIT;
+      reason = adjoint ? "explicit step is monotone, but explicit scheme does not support adjoint mode" : "explicit step is monotone";
+    } else if (z <= stiffness_limit_) {
+      choice = Choice::CRANK_NICOLSON;
+      reason = "explicit step is not monotone";
+    } else {
+      choice = adjoint ? Choice::IMPLICIT : Choice::TR_BDF2;
+      reason = adjoint ? "stiffness limit exceeded, TR-BDF2 scheme does not support adjoint mode" : "stiffness limit exceeded";
+    }
+    if (choice == choice_) {
+      return;
+    }
+    choice_ = choice;
+    switch (choice) {
+    case Choice::EXPLICIT:
+      scheme_ = BasicExplicitScheme<Real>();
+      break;
+    case Choice::CRANK_NICOLSON:
+      scheme_ = BasicCrankNicolsonScheme<Real>(solver_, rannacher_steps_);
+      if (mass_.size() > 0) {
+	scheme_->setMassMatrix(mass_);
+      }
+      break;
+    case Choice::IMPLICIT:
+      scheme_ = BasicImplicitScheme<Real>(solver_);
+      break;
+    default:
+      scheme_ = BasicTRBDF2Scheme<Real>(solver_);
+      break;
+    }
+    if (verbose_) {
+      std::cout << "AutoScheme: |dt| rho(L) <= " << z << " (stiffness limit " << stiffness_limit_ << "), " << reason << ", using " << scheme_->info() << std::endl;
+    }
+  }
+
+  // instantiations for supported types of elements
+  template class BasicAutoScheme<double>;
+  template class BasicAutoScheme<float>;
+  template class BasicAutoScheme<Dual>;
+}  // namespace marian
@@ -0,0 +1,112 @@
+#ifndef MARIAN_AUTOSCHEME_HPP
+#define MARIAN_AUTOSCHEME_HPP
+
+#include <FDM/schemes/fdScheme.hpp>
+#include <FDM/tridiagonalSolver.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements scheme choosing explicit, Crank-Nicolson or TR-BDF2 scheme basing on the operator and the time grid
+   *
+   * Before each solve the scheme inspects the assembled operator \f$L\f$ and the largest time step of the time grid:
+   * - if all elements of \f$I + dt L\f$ are non-negative, explicit step is monotone and stable in maximum norm,
+   *   so marian::BasicExplicitScheme (the cheapest per step, no tridiagonal system is solved) is used,
+   * - otherwise, if \f$|dt| \rho(L)\f$ does not exceed stiffness limit, marian::BasicCrankNicolsonScheme with Rannacher start-up is used,
+   * - for stiffer problems Crank-Nicolson scheme damps high-frequency components only slightly (its amplification factor tends to -1),
+   *   so L-stable marian::BasicTRBDF2Scheme is used (it costs about two Crank-Nicolson steps).
+   *
+   * Spectral radius \f$\rho(L)\f$ is bounded by the maximal sum of absolute values of elements in a row (Gershgorin theorem).
+   * With mass matrix (see setMassMatrix) Crank-Nicolson scheme is always used, as the only one supporting it.
+   * In adjoint mode (see solveAdjoint) explicit scheme is replaced by Crank-Nicolson scheme
+   * and TR-BDF2 scheme by L-stable marian::BasicImplicitScheme, because they do not support adjoint mode.
+   * Decision is printed to standard output when it changes (see setVerbose).
+   */
+  template<typename Real>
+  class BasicAutoScheme : public DCFDScheme<BasicAutoScheme<Real>, Real> {
+  public:
+    /** \brief Constructor
+     *
+     * \param solver Solver used by implicit schemes
+     * \param rannacher_steps Number of Rannacher steps of Crank-Nicolson scheme
+     * \param stiffness_limit Largest \f$|dt| \rho(L)\f$ for which Crank-Nicolson scheme is used
+     */
+    BasicAutoScheme(SmartPointer<BasicTridiagonalSolver<Real> > solver,
+		    unsigned int rannacher_steps = 2,
+		    double stiffness_limit = STIFFNESS_LIMIT):
+      solver_(solver), rannacher_steps_(rannacher_steps), stiffness_limit_(stiffness_limit) {};
+
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >& solver) override {
+      solver_ = solver;
+      choice_ = Choice::NONE;
+    }
+    /** \brief Provides mass matrix, operator of size 0 removes it
+     *
+     * Mass matrix is forwarded to Crank-Nicolson scheme, which is used whenever mass matrix is set.
+     */
+    bool setMassMatrix(const BasicTridiagonalOperator<Real>& M) override {
+      mass_ = M;
+      choice_ = Choice::NONE;
+      return true;
+    }
+    /** \brief Turns on/off printing the decision to standard output
+     */
+    void setVerbose(bool verbose) {
+      verbose_ = verbose;
+    }
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveWithPrevious(std::vector<Real> f,
+					const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					const std::vector<double>& time_grid,
+					const BasicTridiagonalOperator<Real>& L,
+					std::vector<Real>& previous) override;
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override;
+    std::vector<std::vector<Real> > solveMany(std::vector<std::vector<Real> > f,
+					      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+					      const std::vector<double>& time_grid,
+					      const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveAdjoint(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::vector<Real>& w,
+				   BasicTridiagonalOperator<Real>& dL) override;
+
+    /** \brief Returns scheme name (with name of the scheme chosen in the last solve)
+     */
+    std::string info() const override {
+      return scheme_.isEmpty() ? "Auto" : "Auto " + scheme_->info();
+    }
+  private:
+    /** \brief Schemes which can be chosen
+     */
+    enum class Choice {NONE, EXPLICIT, CRANK_NICOLSON, TR_BDF2, IMPLICIT};
+
+    void choose(const std::vector<double>& time_grid, const BasicTridiagonalOperator<Real>& L, bool adjoint = false);
+
+    static constexpr double STIFFNESS_LIMIT = 1000.0; /*!< \brief Default largest \f$|dt| \rho(L)\f$ for which Crank-Nicolson scheme is used*/
+
+    SmartPointer<BasicTridiagonalSolver<Real> > solver_; /*!< \brief Solver used by implicit schemes*/
+    unsigned int rannacher_steps_;                       /*!< \brief Number of Rannacher steps of Crank-Nicolson scheme*/
+    double stiffness_limit_;                             /*!< \brief Largest \f$|dt| \rho(L)\f$ for which Crank-Nicolson scheme is used*/
+    bool verbose_ = true;                                /*!< \brief True if decision is printed*/
+    Choice choice_ = Choice::NONE;                       /*!< \brief Scheme chosen in the last solve*/
+    SmartPointer<BasicFDScheme<Real> > scheme_;          /*!< \brief Scheme chosen in the last solve*/
+    BasicTridiagonalOperator<Real> mass_;                /*!< \brief Mass matrix, empty if not used*/
+  };
+
+  /** \ingroup schemes
+   * \brief Automatically chosen scheme working with doubles
+   */
+  typedef BasicAutoScheme<double> AutoScheme;
+
+} // namespace marian
+
+#endif /* MARIAN_AUTOSCHEME_HPP */
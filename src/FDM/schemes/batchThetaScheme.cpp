@@ -0,0 +1,107 @@
+#include <FDM/schemes/batchThetaScheme.hpp>
+#include <FDM/schemes/fdScheme.hpp>
+#include <algorithm>
+
+namespace marian {
+
+  /** \brief Solves PDEs defined by provided linear operators and initial and boundary conditions
+   *
+   * Problems are divided into groups of marian::BATCH_WIDTH, each group is stepped through the whole time grid in lockstep.
+   *
+   * \param f Initial conditions, one vector for each problem
+   * \param bcs Boundary conditions, one set for each problem
+   * \param time_grid Time grid shared by all problems
+   * \param L Linear operators defining PDEs, one for each problem
+   * \returns Solutions, one vector for each problem
+   */
+  std::vector<std::vector<double> > BatchThetaScheme::solve(std::vector<std::vector<double> > f,
+							    const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+							    const std::vector<double>& time_grid,
+							    const std::vector<TridiagonalOperator>& L) {
+    for (unsigned int first = 0; first < f.size(); first += BATCH_WIDTH) {
+      unsigned int lanes = std::min<unsigned int>(BATCH_WIDTH, f.size() - first);
+      std::vector<std::vector<double> > group(lanes);
+      for (unsigned int k = 0; k < lanes; ++k) {
+	group[k].swap(f[first + k]);
+      }
+
+      dt_ = 0.0;
+      for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+	auto dt = time_grid.at(i+1) - time_grid.at(i);
+	step(group, bcs, time_grid.at(i), dt, L, first);
+      }
+
+      for (unsigned int k = 0; k < lanes; ++k) {
+	group[k].swap(f[first + k]);
+      }
+    }
+    return f;
+  }
+
+  /** \brief Performs single step for a group of problems
+   *
+   * Operators are assembled only when the time step changes. Boundary conditions are applied to each problem separately.
+   * Implicit systems of the whole group are factorized only if any of the operators modified by boundary conditions has changed.
+   *
+   * \param f Solutions of the group, overwritten by solutions on the next time level
+   * \param bcs Boundary conditions of all problems
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operators of all problems
+   * \param first Index of the first problem in the group
+   */
+  void BatchThetaScheme::step(std::vector<std::vector<double> >& f,
+			      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+			      double t,
+			      double dt,
+			      const std::vector<TridiagonalOperator>& L,
+			      unsigned int first) {
+    auto lanes = f.size();
+    if (!FDScheme::isSameTimeStep(dt, dt_)) {
+      exp_base_.resize(lanes);
+      imp_base_.resize(lanes);
+      for (unsigned int k = 0; k < lanes; ++k) {
+	auto I = TridiagonalOperator::I(L.at(first + k).size());
+	exp_base_[k] = I + (1.0 - theta_) * dt * L.at(first + k);
+	imp_base_[k] = I - theta_ * dt * L.at(first + k);
+      }
+      dt_ = dt;
+    }
+
+    if (theta_ < 1.0) {
+      diff_exp_.resize(lanes);
+      for (unsigned int k = 0; k < lanes; ++k) {
+	diff_exp_[k] = exp_base_[k];
+	for (auto bc : bcs.at(first + k)) {
+	  bc->beforeExplicitStep(diff_exp_[k]);
+	}
+	buffer_.resize(f[k].size());
+	diff_exp_[k].apply(f[k], buffer_);
+	f[k].swap(buffer_);
+	for (auto bc : bcs.at(first + k)) {
+	  bc->afterExplicitStep(f[k], t);
+	}
+      }
+    }
+
+    if (theta_ > 0.0) {
+      diff_imp_.resize(lanes);
+      for (unsigned int k = 0; k < lanes; ++k) {
+	diff_imp_[k] = imp_base_[k];
+	for (auto bc : bcs.at(first + k)) {
+	  bc->beforeImplicitStep(diff_imp_[k], f[k], t);
+	}
+      }
+      if (!solver_.isFactorized(diff_imp_)) {
+	solver_.factorize(diff_imp_);
+      }
+      solver_.solveFactorized(f);
+      for (unsigned int k = 0; k < lanes; ++k) {
+	for (auto bc : bcs.at(first + k)) {
+	  bc->afterImplicitStep(f[k], t);
+	}
+      }
+    }
+  }
+
+}  // namespace marian
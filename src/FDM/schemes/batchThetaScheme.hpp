@@ -0,0 +1,95 @@
+#ifndef MARIAN_BATCHTHETASCHEME_HPP
+#define MARIAN_BATCHTHETASCHEME_HPP
+
+#include <vector>
+#include <utils/smartPointer.hpp>
+#include <FDM/batchLUSolver.hpp>
+#include <FDM/boundaryConditions/boundaryCondition.hpp>
+
+namespace marian {
+
+  /** \ingroup schemes
+   * \brief Class implements theta scheme solving many independent problems in lockstep
+   *
+   * Scheme solves many PDEs of the form
+   * \f[\frac{df(x,t)}{dt} = L f(x,t)\f]
+   * defined on the grids of the same size and sharing the time grid (for example the same option priced for many markets).
+   * Each time step is given by
+   * \f[(I - \theta \, dt L) f(x,t_{j+1}) = (I + (1-\theta) dt L) f(x,t_{j}) \f]
+   * Problems are processed in groups of marian::BATCH_WIDTH. Explicit part and boundary conditions are applied to each problem separately,
+   * the tridiagonal systems of the whole group are solved simultaneously by marian::BatchLUSolver.
+   *
+   * Schemes: marian::BatchExplicitScheme, marian::BatchImplicitScheme and marian::BatchCrankNicolsonScheme
+   * give the same results as marian::ExplicitScheme, marian::ImplicitScheme and marian::CrankNicolsonScheme applied to each problem.
+   *
+   * Lockstep requires grids of the same size and common time grid, so the scheme is meant for problems prepared together
+   * (e.g. one PricingPlan priced for many markets). FDMPricer::priceBatch accepts requests with different options, grid sizes
+   * and schemes of the pricer (e.g. Rannacher start-up, adaptive time stepping), so it prices requests with copies of the pricer instead.
+   */
+  class BatchThetaScheme {
+  public:
+    /** \brief Constructor
+     *
+     * \param theta Weight of implicit part: 0.0 explicit, 1.0 implicit, 0.5 Crank-Nicolson scheme
+     */
+    explicit BatchThetaScheme(double theta): theta_(theta) {};
+
+    std::vector<std::vector<double> > solve(std::vector<std::vector<double> > f,
+					    const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+					    const std::vector<double>& time_grid,
+					    const std::vector<TridiagonalOperator>& L);
+
+    /** \brief Destructor
+     */
+    virtual ~BatchThetaScheme(){};
+  private:
+    void step(std::vector<std::vector<double> >& f,
+	      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+	      double t,
+	      double dt,
+	      const std::vector<TridiagonalOperator>& L,
+	      unsigned int first);
+
+    double theta_;                                /*!< \brief Weight of implicit part*/
+    BatchLUSolver solver_;                        /*!< \brief Solver used in implicit step*/
+    std::vector<TridiagonalOperator> exp_base_;   /*!< \brief Explicit operators assembled for time step dt_*/
+    std::vector<TridiagonalOperator> imp_base_;   /*!< \brief Implicit operators assembled for time step dt_*/
+    std::vector<TridiagonalOperator> diff_exp_;   /*!< \brief Explicit operators of the actual step after applying boundary conditions*/
+    std::vector<TridiagonalOperator> diff_imp_;   /*!< \brief Implicit operators of the actual step after applying boundary conditions*/
+    std::vector<double> buffer_;                  /*!< \brief Buffer for solution after explicit step*/
+    double dt_ = 0.0;                             /*!< \brief Time step for which operators were assembled*/
+  };
+
+  /** \ingroup schemes
+   * \brief Explicit scheme solving many independent problems in lockstep (see marian::BatchThetaScheme)
+   */
+  class BatchExplicitScheme : public BatchThetaScheme {
+  public:
+    /** \brief Constructor
+     */
+    BatchExplicitScheme(): BatchThetaScheme(0.0) {};
+  };
+
+  /** \ingroup schemes
+   * \brief Implicit scheme solving many independent problems in lockstep (see marian::BatchThetaScheme)
+   */
+  class BatchImplicitScheme : public BatchThetaScheme {
+  public:
+    /** \brief Constructor
+     */
+    BatchImplicitScheme(): BatchThetaScheme(1.0) {};
+  };
+
+  /** \ingroup schemes
+   * \brief Crank-Nicolson scheme solving many independent problems in lockstep (see marian::BatchThetaScheme)
+   */
+  class BatchCrankNicolsonScheme : public BatchThetaScheme {
+  public:
+    /** \brief Constructor
+     */
+    BatchCrankNicolsonScheme(): BatchThetaScheme(0.5) {};
+  };
+
+} // namespace marian
+
+#endif /* MARIAN_BATCHTHETASCHEME_HPP */
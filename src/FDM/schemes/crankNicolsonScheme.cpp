@@ -1,42 +1,69 @@
 #include <FDM/schemes/crankNicolsonScheme.hpp>
+#include <utils/dualNumber.hpp>
 #include <utils/DataFrame.hpp>
 
 namespace marian {
 
   /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
    * 
+   * First rannacher_steps_ time steps are performed as two implicit half-steps (see halfStep).
+   *
    * \param f Initial condition 
    * \param bcs Boundary conditions
    * \param time_grid Time grid used in
    * \param L Linear operator defining PDE
    * \returns Solution in form of std::vector
    */
-  std::vector<double> CrankNicolsonScheme::solve(std::vector<double> f,
-						 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-						 const std::vector<double>& time_grid,
-						 const TridiagonalOperator& L) {
-    auto I = TridiagonalOperator::I(L.size());
+  template<typename Real>
+  std::vector<Real> BasicCrankNicolsonScheme<Real>::solve(std::vector<Real> f,
+							  const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							  const std::vector<double>& time_grid,
+							  const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
+    buffer_.resize(f.size());
     for (unsigned int i = 0; i < time_grid.size()-1; i++) {
       auto dt = time_grid.at(i+1) - time_grid.at(i);
-      auto diff_exp = I + 0.5 * dt * L;
-      auto diff_imp = I - 0.5 * dt * L;
-      
-      for (auto bc : bcs) {
-	bc->beforeExplicitStep(diff_exp);
-      }
-      f = diff_exp * f;
-      for (auto bc : bcs) {
-	bc->afterExplicitStep(f, time_grid.at(i));
+      if (i < rannacher_steps_) {
+	halfStep(f, bcs, time_grid.at(i), dt, L);
+	halfStep(f, bcs, time_grid.at(i) + 0.5 * dt, dt, L);
+      } else {
+	step(f, bcs, time_grid.at(i), dt, L);
       }
-      
-      for (auto bc : bcs) {
-	bc->beforeImplicitStep(diff_imp, f, time_grid.at(i));
+    }
+    return f;
+  }
+
+  /** \brief Solves PDE and provides also the solution on the next to last level of time grid
+   *
+   * Steps (including Rannacher start-up) are performed as in solve, solution is recorded before the last step.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param previous Overwritten by solution on the next to last level of time grid
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicCrankNicolsonScheme<Real>::solveWithPrevious(std::vector<Real> f,
+								      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								      const std::vector<double>& time_grid,
+								      const BasicTridiagonalOperator<Real>& L,
+								      std::vector<Real>& previous) {
+    dt_ = 0.0;
+    buffer_.resize(f.size());
+    previous = f;
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      if (i + 2 == time_grid.size()) {
+	previous = f;
       }
-      f = solver_->solve(diff_imp, f);
-      for (auto bc : bcs) {
-	bc->afterImplicitStep(f ,time_grid.at(i));
+      if (i < rannacher_steps_) {
+	halfStep(f, bcs, time_grid.at(i), dt, L);
+	halfStep(f, bcs, time_grid.at(i) + 0.5 * dt, dt, L);
+      } else {
+	step(f, bcs, time_grid.at(i), dt, L);
       }
-      
     }
     return f;
   }
@@ -51,51 +78,440 @@ namespace marian {
    * \param file_name Name of CSV file
    * \returns Solution in form of std::vector
    */ 
-  std::vector<double> CrankNicolsonScheme::solveAndSave(std::vector<double> f,
-							const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-							const std::vector<double>& spatial_grid,
-							const std::vector<double>& time_grid,
-							const TridiagonalOperator& L,
-							const std::string file_name) {
+  template<typename Real>
+  std::vector<Real> BasicCrankNicolsonScheme<Real>::solveAndSave(std::vector<Real> f,
+								 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								 const std::vector<double>& spatial_grid,
+								 const std::vector<double>& time_grid,
+								 const BasicTridiagonalOperator<Real>& L,
+								 const std::string file_name) {
     DataFrame df;
     for (unsigned int i = 0; i < f.size(); i++) {
       DataEntryClerk input;
       input.add("T", time_grid.front());
       input.add("S", spatial_grid.at(i));
-      input.add("f", f.at(i));
+      input.add("f", static_cast<double>(f.at(i)));
       df.append(input);
     }
     
-    auto I = TridiagonalOperator::I(L.size());
+    dt_ = 0.0;
+    buffer_.resize(f.size());
     for (unsigned int i = 0; i < time_grid.size()-1; i++) {
       auto dt = time_grid.at(i+1) - time_grid.at(i);
-      auto diff_exp = I + 0.5 * dt * L;
-      auto diff_imp = I - 0.5 * dt * L;
-      
-      for (auto bc : bcs) {
-	bc->beforeExplicitStep(diff_exp);
+      if (i < rannacher_steps_) {
+	halfStep(f, bcs, time_grid.at(i), dt, L);
+	halfStep(f, bcs, time_grid.at(i) + 0.5 * dt, dt, L);
+      } else {
+	step(f, bcs, time_grid.at(i), dt, L);
       }
-      f = diff_exp * f;
-      for (auto bc : bcs) {
-	bc->afterExplicitStep(f, time_grid.at(i));
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", time_grid.at(i+1));
+	input.add("S", spatial_grid.at(j));
+	input.add("f", static_cast<double>(f.at(j)));
+	df.append(input);
       }
+    }
+    df.printToCsv(file_name,';');
+    return f;
+  }
+
+  /** \brief Performs single Crank-Nicolson step
+   *
+   * Operators \f$I + 0.5 dt L\f$ and \f$I - 0.5 dt L\f$ are assembled only when the time step changes (see assemble). 
+   * The factorization of implicit operator is reused as long as the operator modified by boundary conditions stays the same,
+   * so for uniform time grid the tridiagonal matrix is factorized only once. 
+   * The explicit step writes to internal buffer and the implicit step writes back to \b f, so the step does not allocate memory.
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicCrankNicolsonScheme<Real>::step(std::vector<Real>& f,
+					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					    double t,
+					    double dt,
+					    const BasicTridiagonalOperator<Real>& L) {
+    if (fused_ && mass_.size() == 0 && fusedStep(f, bcs, t, dt, L)) {
+      return;
+    }
+    assemble(dt, L);
+    diff_exp_ = exp_base_;
+    diff_imp_ = imp_base_;
+
+    for (auto bc : bcs) {
+      bc->beforeExplicitStep(diff_exp_);
+    }
+    diff_exp_.apply(f, buffer_);
+    for (auto bc : bcs) {
+      bc->afterExplicitStep(buffer_, t);
+    }
       
+    for (auto bc : bcs) {
+      bc->beforeImplicitStep(diff_imp_, buffer_, t);
+    }
+    if (!solver_->isFactorized(diff_imp_)) {
+      solver_->factorize(diff_imp_);
+    }
+    solver_->solveFactorized(buffer_, f);
+    for (auto bc : bcs) {
+      bc->afterImplicitStep(f, t);
+    }
+  }
+
+  /** \brief Performs single Crank-Nicolson step with fused kernel if all boundary conditions are Dirichlet conditions
+   *
+   * Explicit operator is expressed by implicit one, \f$I + 0.5 dt L = 2I - (I - 0.5 dt L)\f$, so the right-hand side
+   * \f$w_i = 2 f_i - ((I - 0.5 dt L) f)_i\f$ is computed inside the forward elimination of LU factorization and is never stored.
+   * Rows fixed by Dirichlet conditions are handled inline (their right-hand side is the boundary value).
+   * Single streaming pass reads the solution, diagonals of the operator and pivots and writes the intermediate vector,
+   * back substitution writes the solution. Operators are not copied and boundary conditions are not cloned in the step.
+   *
+   * LU factors of the implicit operator with fixed rows are computed when the time step or the fixed boundaries change.
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   * \returns False if some boundary condition is not Dirichlet condition (step is not performed)
+   */
+  template<typename Real>
+  bool BasicCrankNicolsonScheme<Real>::fusedStep(std::vector<Real>& f,
+						 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						 double t,
+						 double dt,
+						 const BasicTridiagonalOperator<Real>& L) {
+    int fixed = 0;
+    double low_value = 0.0;
+    double upp_value = 0.0;
+    for (auto& bc : bcs) {
+      BCSide side;
+      if (!bc->isDirichlet(side)) {
+	return false;
+      }
+      if (side == BCSide::LOW) {
+	fixed |= 1;
+	low_value = bc->dirichletValue(t);
+      } else {
+	fixed |= 2;
+	upp_value = bc->dirichletValue(t);
+      }
+    }
+    bool low_fixed = fixed & 1;
+    bool upp_fixed = fixed & 2;
+
+    assemble(dt, L);
+    const auto& A = imp_base_;
+    unsigned int n = f.size();
+    if (fused_fixed_ != fixed) {
+      fused_gam_.assign(n, Real(0.0));
+      fused_ibet_.assign(n, Real(0.0));
+      fused_ibet_[0] = low_fixed ? Real(1.0) : 1.0 / A.evalMid(0);
+      for (unsigned int i = 1; i < n; ++i) {
+	bool last_fixed = i == n - 1 && upp_fixed;
+	Real upp = i == 1 && low_fixed ? Real(0.0) : A.evalUpp(i-1);
+	Real low = last_fixed ? Real(0.0) : A.evalLow(i-1);
+	Real mid = last_fixed ? Real(1.0) : A.evalMid(i);
+	fused_gam_[i] = upp * fused_ibet_[i-1];
+	fused_ibet_[i] = 1.0 / (mid - low * fused_gam_[i]);
+      }
+      fused_fixed_ = fixed;
+    }
+
+    // explicit product fused with forward elimination
+    auto& y = buffer_;
+    y[0] = low_fixed ? Real(low_value) : (2.0 * f[0] - (A.evalMid(0) * f[0] + A.evalUpp(0) * f[1])) * fused_ibet_[0];
+    for (unsigned int i = 1; i < n - 1; ++i) {
+      Real w = 2.0 * f[i] - (A.evalLow(i-1) * f[i-1] + A.evalMid(i) * f[i] + A.evalUpp(i) * f[i+1]);
+      y[i] = (w - A.evalLow(i-1) * y[i-1]) * fused_ibet_[i];
+    }
+    if (upp_fixed) {
+      y[n-1] = upp_value;
+    } else {
+      Real w = 2.0 * f[n-1] - (A.evalLow(n-2) * f[n-2] + A.evalMid(n-1) * f[n-1]);
+      y[n-1] = (w - A.evalLow(n-2) * y[n-2]) * fused_ibet_[n-1];
+    }
+
+    // back substitution
+    f[n-1] = y[n-1];
+    for (unsigned int i = n - 1; i > 0; --i) {
+      f[i-1] = y[i-1] - fused_gam_[i] * f[i];
+    }
+    return true;
+  }
+
+  /** \brief Performs implicit Euler step of length 0.5 dt used in Rannacher start-up
+   *
+   * Implicit operator of half-step \f$I - 0.5 dt L\f$ is the same as implicit operator of Crank-Nicolson step,
+   * so the factorization is shared with Crank-Nicolson steps of the same length. With mass matrix the right-hand side is \f$M f\f$.
+   *
+   * \param f Solution, overwritten by solution after half-step
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step of Crank-Nicolson scheme (twice the length of half-step)
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicCrankNicolsonScheme<Real>::halfStep(std::vector<Real>& f,
+						const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						double t,
+						double dt,
+						const BasicTridiagonalOperator<Real>& L) {
+    assemble(dt, L);
+    diff_imp_ = imp_base_;
+    if (mass_.size() == L.size()) {
+      mass_.apply(f, buffer_);
+      f.swap(buffer_);
+    }
+
+    for (auto bc : bcs) {
+      bc->beforeImplicitStep(diff_imp_, f, t);
+    }
+    if (!solver_->isFactorized(diff_imp_)) {
+      solver_->factorize(diff_imp_);
+    }
+    solver_->solveFactorized(f, f);
+    for (auto bc : bcs) {
+      bc->afterImplicitStep(f, t);
+    }
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L for many initial conditions
+   *
+   * All problems are stepped together. In each time step the implicit operator is factorized at most once 
+   * and the systems of all problems are solved with multi-column substitution (see TridiagonalSolver::solveFactorized).
+   * 
+   * \param f Initial conditions, one vector (column) for each problem
+   * \param bcs Boundary conditions, one set for each problem
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solutions, one vector for each problem
+   */
+  template<typename Real>
+  std::vector<std::vector<Real> > BasicCrankNicolsonScheme<Real>::solveMany(std::vector<std::vector<Real> > f,
+									    const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+									    const std::vector<double>& time_grid,
+									    const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
+    buffers_.resize(f.size());
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      buffers_[c].resize(f[c].size());
+    }
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      if (i < rannacher_steps_) {
+	halfStepMany(f, bcs, time_grid.at(i), dt, L);
+	halfStepMany(f, bcs, time_grid.at(i) + 0.5 * dt, dt, L);
+      } else {
+	stepMany(f, bcs, time_grid.at(i), dt, L);
+      }
+    }
+    return f;
+  }
+
+  /** \brief Performs single Crank-Nicolson step for many problems
+   *
+   * Boundary conditions of all problems are applied to the same explicit and implicit operator.
+   * Solutions after explicit step are written to buffers, which are then swapped with solutions and solved in place.
+   *
+   * \param f Solutions, overwritten by solutions on the next time level
+   * \param bcs Boundary conditions, one set for each problem
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicCrankNicolsonScheme<Real>::stepMany(std::vector<std::vector<Real> >& f,
+						const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+						double t,
+						double dt,
+						const BasicTridiagonalOperator<Real>& L) {
+    assemble(dt, L);
+    diff_exp_ = exp_base_;
+    diff_imp_ = imp_base_;
+
+    for (auto& column_bcs : bcs) {
+      for (auto bc : column_bcs) {
+	bc->beforeExplicitStep(diff_exp_);
+      }
+    }
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      diff_exp_.apply(f[c], buffers_[c]);
+      for (auto bc : bcs.at(c)) {
+	bc->afterExplicitStep(buffers_[c], t);
+      }
+      for (auto bc : bcs.at(c)) {
+	bc->beforeImplicitStep(diff_imp_, buffers_[c], t);
+      }
+    }
+
+    if (!solver_->isFactorized(diff_imp_)) {
+      solver_->factorize(diff_imp_);
+    }
+    f.swap(buffers_);
+    solver_->solveFactorized(f);
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      for (auto bc : bcs.at(c)) {
+	bc->afterImplicitStep(f[c], t);
+      }
+    }
+  }
+
+  /** \brief Performs implicit half-step of Rannacher start-up for many problems
+   *
+   * \param f Solutions, overwritten by solutions after half-step
+   * \param bcs Boundary conditions, one set for each problem
+   * \param t Actual time
+   * \param dt Time step of Crank-Nicolson scheme (twice the length of half-step)
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicCrankNicolsonScheme<Real>::halfStepMany(std::vector<std::vector<Real> >& f,
+						    const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+						    double t,
+						    double dt,
+						    const BasicTridiagonalOperator<Real>& L) {
+    assemble(dt, L);
+    diff_imp_ = imp_base_;
+
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      if (mass_.size() == L.size()) {
+	mass_.apply(f[c], buffers_[c]);
+	f[c].swap(buffers_[c]);
+      }
+      for (auto bc : bcs.at(c)) {
+	bc->beforeImplicitStep(diff_imp_, f[c], t);
+      }
+    }
+    if (!solver_->isFactorized(diff_imp_)) {
+      solver_->factorize(diff_imp_);
+    }
+    solver_->solveFactorized(f);
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      for (auto bc : bcs.at(c)) {
+	bc->afterImplicitStep(f[c], t);
+      }
+    }
+  }
+
+  /** \brief Solves PDE and computes derivatives of functional \f$w \cdot f_N\f$ with respect to elements of operator \b L
+   *
+   * Solution is recorded on all time levels. Going backward in time, the adjoint vector \f$\lambda_N = w\f$ is propagated by:
+   * \f[ (I - 0.5 dt L)^T \mu_n = \lambda_n, \qquad \lambda_{n-1} = (I + 0.5 dt L)^T \mu_n \f]
+   * (operators are modified by boundary conditions, elements of \f$\mu_n\f$ on the fixed rows are cleared)
+   * and the derivatives are accumulated as \f$\partial P/\partial L_{ij} = \sum_n 0.5 dt \mu_{n,i} (f_{n-1,j} + f_{n,j})\f$.
+   * Transposed systems are solved by copy of the solver, so its factorization is reused for uniform time grid.
+   * In Rannacher start-up steps each implicit half-step propagates the adjoint vector by \f$(I - 0.5 dt L)^T\f$ only (followed by \f$M^T\f$ with mass matrix)
+   * and contributes \f$0.5 dt \mu_i f_j\f$, where \f$f\f$ is the solution after the half-step.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param w Weights defining functional of the final solution
+   * \param dL Overwritten by derivatives of functional with respect to elements of \b L
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicCrankNicolsonScheme<Real>::solveAdjoint(std::vector<Real> f,
+								 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								 const std::vector<double>& time_grid,
+								 const BasicTridiagonalOperator<Real>& L,
+								 const std::vector<Real>& w,
+								 BasicTridiagonalOperator<Real>& dL) {
+    unsigned int steps = time_grid.size() - 1;
+    std::vector<std::vector<Real> > levels;
+    levels.reserve(steps + 1);
+    levels.push_back(f);
+    dt_ = 0.0;
+    buffer_.resize(f.size());
+    std::vector<std::vector<Real> > halves;
+    for (unsigned int i = 0; i < steps; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      if (i < rannacher_steps_) {
+	halfStep(f, bcs, time_grid.at(i), dt, L);
+	halves.push_back(f);
+	halfStep(f, bcs, time_grid.at(i) + 0.5 * dt, dt, L);
+      } else {
+	step(f, bcs, time_grid.at(i), dt, L);
+      }
+      levels.push_back(f);
+    }
+
+    SmartPointer<BasicTridiagonalSolver<Real> > adjoint_solver = solver_;
+    std::vector<Real> lambda(w);
+    std::vector<Real> mu(f.size());
+    std::vector<Real> sum(f.size());
+    dL = BasicTridiagonalOperator<Real>(L.size());
+    for (unsigned int i = steps; i > 0; i--) {
+      auto t = time_grid.at(i-1);
+      auto dt = time_grid.at(i) - t;
+      assemble(dt, L);
+      diff_exp_ = exp_base_;
+      diff_imp_ = imp_base_;
       for (auto bc : bcs) {
-	bc->beforeImplicitStep(diff_imp, f, time_grid.at(i));
+	bc->beforeExplicitStep(diff_exp_);
       }
-      f = solver_->solve(diff_imp, f);
       for (auto bc : bcs) {
-	bc->afterImplicitStep(f,  time_grid.at(i));
+	bc->beforeImplicitStep(diff_imp_, buffer_, t);
       }
+
+      auto imp_transposed = diff_imp_.transpose();
+      if (!adjoint_solver->isFactorized(imp_transposed)) {
+	adjoint_solver->factorize(imp_transposed);
+      }
+
+      if (i <= rannacher_steps_) {
+	// second and first implicit half-step, lambda is propagated by transposed implicit operator (and mass matrix)
+	for (const auto* level : {&levels[i], &halves[i-1]}) {
+	  adjoint_solver->solveFactorized(lambda, mu);
+	  this->clearFixedRows(imp_base_, diff_imp_, mu);
+	  dL.addOuterProduct(0.5 * dt, mu, *level);
+	  if (mass_.size() == L.size()) {
+	    mass_.transpose().apply(mu, lambda);
+	  } else {
+	    lambda.swap(mu);
+	  }
+	}
+	continue;
+      }
+
+      adjoint_solver->solveFactorized(lambda, mu);
+      this->clearFixedRows(imp_base_, diff_imp_, mu);
+
       for (unsigned int j = 0; j < f.size(); j++) {
-	DataEntryClerk input;
-	input.add("T", time_grid.at(i+1));
-	input.add("S", spatial_grid.at(j));
-	input.add("f", f.at(j));
-	df.append(input);
+	sum[j] = levels[i-1][j] + levels[i][j];
       }
+      dL.addOuterProduct(0.5 * dt, mu, sum);
+      diff_exp_.transpose().apply(mu, lambda);
     }
-    df.printToCsv(file_name,';');
     return f;
   }
+
+  /** \brief Assembles operators \f$I + 0.5 dt L\f$ and \f$I - 0.5 dt L\f$ if time step has changed
+   *
+   * Mass matrix replaces identity if it is provided.
+   *
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicCrankNicolsonScheme<Real>::assemble(double dt, const BasicTridiagonalOperator<Real>& L) {
+    if (!this->isSameTimeStep(dt, dt_)) {
+      auto I = mass_.size() == L.size() ? mass_ : BasicTridiagonalOperator<Real>::I(L.size());
+      exp_base_ = I + 0.5 * dt * L;
+      imp_base_ = I - 0.5 * dt * L;
+      dt_ = dt;
+      fused_fixed_ = -1;
+    }
+  }
+
+  // instantiations for supported types of elements
+  template class BasicCrankNicolsonScheme<double>;
+  template class BasicCrankNicolsonScheme<float>;
+  template class BasicCrankNicolsonScheme<Dual>;
 }  // namespace marian
@@ -11,35 +11,134 @@ namespace marian {
    * 
    * Crank-Nicolson is a combination of the implicit method and the explicit Euler method. In each time step, two steps: explicit and implicit are performed.
    * The Crank-Nicolson scheme is unconditionally stable and have better convergence that implicit schemes and explicit schemes alone.
+   *
+   * Crank-Nicolson does not damp high-frequency components of the solution, so non-smooth initial conditions (like payoffs with kink at strike)
+   * produce oscillations of delta and gamma near the kink. In Rannacher mode first time steps are replaced by two implicit half-steps each,
+   * which damp these components, so the scheme recovers second order convergence on coarse grids.
+   * Implicit half-step uses operator \f$I - 0.5 dt L\f$, so it shares the factorization with Crank-Nicolson steps.
+   *
+   * With mass matrix \f$M\f$ (see setMassMatrix) the scheme solves \f$M \frac{df}{dt} = L f\f$ with operators \f$M \pm 0.5 dt L\f$,
+   * so compact discretizations still lead to tridiagonal systems.
+   *
+   * In fused mode (see setFusedStep) steps with Dirichlet conditions on the boundaries are performed by single kernel,
+   * which computes the explicit product inside the forward elimination and then performs back substitution.
    */
-  class CrankNicolsonScheme : public DCFDScheme<CrankNicolsonScheme> {
+  template<typename Real>
+  class BasicCrankNicolsonScheme : public DCFDScheme<BasicCrankNicolsonScheme<Real>, Real> {
   public:
     /** \brief Constructor
      */
-    CrankNicolsonScheme(){};
+    BasicCrankNicolsonScheme(){};
     /** \brief Provides a solver used in implicit scheme
+     *
+     * \param solver Solver used in implicit step
+     * \param rannacher_steps Number of first time steps replaced by two implicit half-steps (Rannacher start-up)
+     */
+    BasicCrankNicolsonScheme(SmartPointer<BasicTridiagonalSolver<Real> > solver, unsigned int rannacher_steps = 0):
+      solver_(solver), rannacher_steps_(rannacher_steps) {};
+
+    /** \brief Sets number of first time steps replaced by two implicit half-steps (0 turns off Rannacher start-up)
+     */
+    void setRannacherSteps(unsigned int rannacher_steps) {
+      rannacher_steps_ = rannacher_steps;
+    }
+    /** \brief Turns on fused Crank-Nicolson step kernel (see fusedStep)
+     *
+     * Fused kernel factorizes the implicit operator itself, so the solver is used only for steps which can not be fused.
+     */
+    void setFusedStep(bool fused) {
+      fused_ = fused;
+    }
+
+    /** \brief Provides mass matrix, operator of size 0 removes it
+     *
+     * Fused kernel is not used with mass matrix.
      */
-    CrankNicolsonScheme(SmartPointer<TridiagonalSolver> solver): solver_(solver) {};
-	
-    void setSolver(const SmartPointer<TridiagonalSolver>& solver) override {
+    bool setMassMatrix(const BasicTridiagonalOperator<Real>& M) override {
+      mass_ = M;
+      dt_ = 0.0;
+      return true;
+    }
+
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >& solver) override {
       solver_ = solver;
     }
-    std::vector<double> solve(std::vector<double> f,
-			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-			      const std::vector<double>& time_grid,
-			      const TridiagonalOperator& L) override;
-    std::vector<double> solveAndSave(std::vector<double> f,
-				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-				     const std::vector<double>& spatial_grid,
-				     const std::vector<double>& time_grid,
-				     const TridiagonalOperator& L,
-				     const std::string file_name) override;
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveWithPrevious(std::vector<Real> f,
+					const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					const std::vector<double>& time_grid,
+					const BasicTridiagonalOperator<Real>& L,
+					std::vector<Real>& previous) override;
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override;
+    std::vector<std::vector<Real> > solveMany(std::vector<std::vector<Real> > f,
+					      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+					      const std::vector<double>& time_grid,
+					      const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveAdjoint(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::vector<Real>& w,
+				   BasicTridiagonalOperator<Real>& dL) override;
     std::string info() const override {
-      return "CrankNicolson";
+      return rannacher_steps_ > 0 ? "CrankNicolson Rannacher(" + std::to_string(rannacher_steps_) + ")" : "CrankNicolson";
     }
   private:
-    SmartPointer<TridiagonalSolver> solver_;   /*!< \brief Sovler used in implicit step*/   
+    void step(std::vector<Real>& f,
+	      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+	      double t,
+	      double dt,
+	      const BasicTridiagonalOperator<Real>& L);
+    bool fusedStep(std::vector<Real>& f,
+		   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+		   double t,
+		   double dt,
+		   const BasicTridiagonalOperator<Real>& L);
+    void halfStep(std::vector<Real>& f,
+		  const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+		  double t,
+		  double dt,
+		  const BasicTridiagonalOperator<Real>& L);
+    void stepMany(std::vector<std::vector<Real> >& f,
+		  const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+		  double t,
+		  double dt,
+		  const BasicTridiagonalOperator<Real>& L);
+    void halfStepMany(std::vector<std::vector<Real> >& f,
+		      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+		      double t,
+		      double dt,
+		      const BasicTridiagonalOperator<Real>& L);
+    void assemble(double dt, const BasicTridiagonalOperator<Real>& L);
+
+    SmartPointer<BasicTridiagonalSolver<Real> > solver_; /*!< \brief Sovler used in implicit step*/
+    BasicTridiagonalOperator<Real> exp_base_;            /*!< \brief Operator \f$I + 0.5 dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> imp_base_;            /*!< \brief Operator \f$I - 0.5 dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> diff_exp_;            /*!< \brief Explicit operator of the actual time step after applying boundary conditions*/
+    BasicTridiagonalOperator<Real> diff_imp_;            /*!< \brief Implicit operator of the actual time step after applying boundary conditions*/
+    std::vector<Real> buffer_;                           /*!< \brief Buffer for solution after explicit step*/
+    std::vector<std::vector<Real> > buffers_;            /*!< \brief Buffers for solutions after explicit step used by solveMany*/
+    double dt_ = 0.0;                                    /*!< \brief Time step for which exp_base_ and imp_base_ were assembled*/
+    unsigned int rannacher_steps_ = 0;                   /*!< \brief Number of first time steps replaced by two implicit half-steps*/
+    BasicTridiagonalOperator<Real> mass_;                /*!< \brief Mass matrix, identity if size is 0*/
+    bool fused_ = false;                                 /*!< \brief True if fused step kernel is used*/
+    std::vector<Real> fused_gam_;                        /*!< \brief Upper diagonal of U factor of implicit operator used by fused kernel*/
+    std::vector<Real> fused_ibet_;                       /*!< \brief Inverted pivots of U factor of implicit operator used by fused kernel*/
+    int fused_fixed_ = -1;                               /*!< \brief Boundaries fixed in factors of fused kernel (bit 0 - lower, bit 1 - upper), -1 if factors are outdated*/
   };
+
+  /** \ingroup schemes
+   * \brief Crank-Nicolson scheme working with doubles
+   */
+  typedef BasicCrankNicolsonScheme<double> CrankNicolsonScheme;
   
 } // namespace marian
 
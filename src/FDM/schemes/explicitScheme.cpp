@@ -1,5 +1,7 @@
 #include <FDM/schemes/explicitScheme.hpp>
+#include <utils/dualNumber.hpp>
 #include <utils/dataFrame.hpp>
+#include <algorithm>
 
 namespace marian {
   /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
@@ -10,24 +12,54 @@ namespace marian {
    * \param L Linear operator defining PDE
    * \returns Solution in form of std::vector
    */
-  std::vector<double> ExplicitScheme::solve(std::vector<double> f,
-					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-					    const std::vector<double>& time_grid,
-					    const TridiagonalOperator& L) {
-    auto I = TridiagonalOperator::I(L.size());
-    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
-      auto dt = time_grid.at(i+1) - time_grid.at(i);
-      auto diff_operator = I + dt * L;
-      for (auto bc : bcs) {
-	bc->beforeExplicitStep(diff_operator);
-      }
-      f = diff_operator * f;
-      for (auto bc : bcs) {
-	bc->afterExplicitStep(f, time_grid.at(i));
+  template<typename Real>
+  std::vector<Real> BasicExplicitScheme<Real>::solve(std::vector<Real> f,
+						     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						     const std::vector<double>& time_grid,
+						     const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
+    buffer_.resize(f.size());
+    for (unsigned int i = 0; i < time_grid.size()-1;) {
+      unsigned int steps = block_steps_ > 1 ? tiledSteps(f, bcs, time_grid, i, L) : 0;
+      if (steps > 0) {
+	i += steps;
+	continue;
       }
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      step(f, bcs, time_grid.at(i), dt, L);
+      i++;
     }
     return f;
   }
+
+  /** \brief Solves PDE and provides also the solution on the next to last level of time grid
+   *
+   * Steps before the last one are performed by solve (with time blocking if it is turned on), then the last step is performed.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param previous Overwritten by solution on the next to last level of time grid
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicExplicitScheme<Real>::solveWithPrevious(std::vector<Real> f,
+								 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								 const std::vector<double>& time_grid,
+								 const BasicTridiagonalOperator<Real>& L,
+								 std::vector<Real>& previous) {
+    if (time_grid.size() < 2) {
+      previous = f;
+      return f;
+    }
+    std::vector<double> head(time_grid.begin(), time_grid.end() - 1);
+    previous = solve(f, bcs, head, L);
+    f = previous;
+    auto dt = time_grid.back() - head.back();
+    step(f, bcs, head.back(), dt, L);
+    return f;
+  }
   /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
    * 
    * \param f Initial condition 
@@ -38,41 +70,164 @@ namespace marian {
    * \param file_name Name of CSV file
    * \returns Solution in form of std::vector
    */
-  std::vector<double> ExplicitScheme::solveAndSave(std::vector<double> f,
-						   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-						   const std::vector<double>& spatial_grid,
-						   const std::vector<double>& time_grid,
-						   const TridiagonalOperator& L,
-						   const std::string file_name) {
+  template<typename Real>
+  std::vector<Real> BasicExplicitScheme<Real>::solveAndSave(std::vector<Real> f,
+							    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							    const std::vector<double>& spatial_grid,
+							    const std::vector<double>& time_grid,
+							    const BasicTridiagonalOperator<Real>& L,
+							    const std::string file_name) {
     DataFrame df;
     for (unsigned int i = 0; i < f.size(); i++) {
       DataEntryClerk input;
       input.add("T", time_grid.front());
       input.add("S", spatial_grid.at(i));
-      input.add("f", f.at(i));
+      input.add("f", static_cast<double>(f.at(i)));
       df.append(input);
     }
     
-    auto I = TridiagonalOperator::I(L.size());
+    dt_ = 0.0;
+    buffer_.resize(f.size());
     for (unsigned int i = 0; i < time_grid.size()-1; i++) {
       auto dt = time_grid.at(i+1) - time_grid.at(i);
-      auto diff_operator = I + dt * L;
-      for (auto bc : bcs) {
-	bc->beforeExplicitStep(diff_operator);
-      }
-      f = diff_operator * f;
-      for (auto bc : bcs) {
-	bc->afterExplicitStep(f, time_grid.at(i));
-      }
+      step(f, bcs, time_grid.at(i), dt, L);
       for (unsigned int j = 0; j < f.size(); j++) {
 	DataEntryClerk input;
 	input.add("T", time_grid.at(i+1));
 	input.add("S", spatial_grid.at(j));
-	input.add("f", f.at(j));
+	input.add("f", static_cast<double>(f.at(j)));
 	df.append(input);
       }
     }
     df.printToCsv(file_name,';');
     return f;
   }
+
+  /** \brief Performs single explicit step
+   *
+   * Operator \f$I + dt L\f$ is assembled only when the time step changes. 
+   * The solution on the next time level is written to internal buffer which is then swapped with \b f,
+   * so the step does not allocate memory.
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicExplicitScheme<Real>::step(std::vector<Real>& f,
+				       const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				       double t,
+				       double dt,
+				       const BasicTridiagonalOperator<Real>& L) {
+    if (!this->isSameTimeStep(dt, dt_)) {
+      diff_base_ = BasicTridiagonalOperator<Real>::I(L.size()) + dt * L;
+      dt_ = dt;
+    }
+    diff_operator_ = diff_base_;
+    for (auto bc : bcs) {
+      bc->beforeExplicitStep(diff_operator_);
+    }
+    diff_operator_.apply(f, buffer_);
+    f.swap(buffer_);
+    for (auto bc : bcs) {
+      bc->afterExplicitStep(f, t);
+    }
+  }
+
+  /** \brief Performs block of explicit steps tile by tile (temporal blocking)
+   *
+   * Grid is divided into tiles of tile_width_ nodes. Steps of the block are performed for the first tile, then for the second one and so on.
+   * On the k-th time level of the block the tile is shifted left by k nodes (time skewing), so the values on the previous level
+   * needed by the 3-point stencil were already computed by this or the previous tile. Values of the tile stay in cache between the levels,
+   * so the solution is read from and written to memory once per block instead of once per step.
+   *
+   * Levels are stored alternately in \b f and in the buffer. Tile writing level k+1 overwrites level k-1 only at nodes
+   * which are not used anymore by this and the next tile, so two vectors are sufficient.
+   *
+   * Block contains at most block_steps_ steps of the same length, so operator \f$I + dt L\f$ is shared by the whole block.
+   * Dirichlet conditions are applied inline on each level with the value for the time of the step, so time-dependent boundary values are preserved.
+   * Other boundary conditions modify the whole solution in their hooks, so they can not be tiled.
+   *
+   * \param f Solution, overwritten by solution after the block
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used for time dimension of FDM
+   * \param first Index of time level at which the block starts
+   * \param L Linear operator defining PDE
+   * \returns Number of performed steps, 0 if block can not be tiled (non-Dirichlet condition, too small grid or single step)
+   */
+  template<typename Real>
+  unsigned int BasicExplicitScheme<Real>::tiledSteps(std::vector<Real>& f,
+						     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						     const std::vector<double>& time_grid,
+						     unsigned int first,
+						     const BasicTridiagonalOperator<Real>& L) {
+    unsigned int n = f.size();
+    double dt = time_grid.at(first+1) - time_grid.at(first);
+    unsigned int block = 1;
+    while (block < block_steps_ && first + block + 1 < time_grid.size()
+	   && this->isSameTimeStep(time_grid.at(first+block+1) - time_grid.at(first+block), dt)) {
+      block++;
+    }
+    if (block < 2 || n < 3) {
+      return 0;
+    }
+
+    bool low_fixed = false;
+    bool upp_fixed = false;
+    low_values_.resize(block);
+    upp_values_.resize(block);
+    for (auto& bc : bcs) {
+      BCSide side;
+      if (!bc->isDirichlet(side)) {
+	return 0;
+      }
+      bool low = side == BCSide::LOW;
+      low_fixed = low_fixed || low;
+      upp_fixed = upp_fixed || !low;
+      for (unsigned int k = 0; k < block; ++k) {
+	(low ? low_values_ : upp_values_)[k] = bc->dirichletValue(time_grid.at(first+k));
+      }
+    }
+
+    if (!this->isSameTimeStep(dt, dt_)) {
+      diff_base_ = BasicTridiagonalOperator<Real>::I(L.size()) + dt * L;
+      dt_ = dt;
+    }
+    const auto& A = diff_base_;
+    std::vector<Real>* levels[2] = {&f, &buffer_};
+    unsigned int width = std::max(tile_width_, block + 2);
+
+    for (unsigned int a = 0; a < n + block; a += width) {
+      for (unsigned int k = 1; k <= block; ++k) {
+	const std::vector<Real>& u = *levels[(k-1) % 2];
+	std::vector<Real>& v = *levels[k % 2];
+	unsigned int begin = a > k ? a - k : 0;
+	unsigned int end = std::min(n, a + width - k);
+	if (begin >= end) {
+	  continue;
+	}
+	if (begin == 0) {
+	  v[0] = low_fixed ? Real(low_values_[k-1]) : A.evalMid(0) * u[0] + A.evalUpp(0) * u[1];
+	}
+	unsigned int last = std::min(end, n - 1);
+	for (unsigned int j = std::max(begin, 1u); j < last; ++j) {
+	  v[j] = A.evalLow(j-1) * u[j-1] + A.evalMid(j) * u[j] + A.evalUpp(j) * u[j+1];
+	}
+	if (end == n) {
+	  v[n-1] = upp_fixed ? Real(upp_values_[k-1]) : A.evalLow(n-2) * u[n-2] + A.evalMid(n-1) * u[n-1];
+	}
+      }
+    }
+    if (block % 2 == 1) {
+      f.swap(buffer_);
+    }
+    return block;
+  }
+
+  // instantiations for supported types of elements
+  template class BasicExplicitScheme<double>;
+  template class BasicExplicitScheme<float>;
+  template class BasicExplicitScheme<Dual>;
 }  // namespace fdm
@@ -18,16 +18,30 @@ namespace marian {
    \end{aligned}
    \f]
    * For more information see  \cite DuffyFDM \cite ClarkFx \cite MortonMayers . 
+   *
+   * Single explicit step streams the whole grid through memory, so for grids exceeding the cache the scheme is limited by memory bandwidth.
+   * In temporally blocked mode (see setTimeBlocking) several time steps are performed for tiles of the grid small enough to stay in cache
+   * (see tiledSteps). The results are identical to the results of step-by-step solution.
    */
-  class ExplicitScheme : public DCFDScheme<ExplicitScheme> {
+  template<typename Real>
+  class BasicExplicitScheme : public DCFDScheme<BasicExplicitScheme<Real>, Real> {
   public:
-    ExplicitScheme(){};
+    BasicExplicitScheme(){};
     /** \brief Provides a solver used in implicit scheme.
      *
      *
      * For explicit method this method is empty.
      */
-    void setSolver(const SmartPointer<TridiagonalSolver>&) override {
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >&) override {
+    }
+    /** \brief Turns on temporally blocked mode
+     *
+     * \param steps Number of time steps performed for each tile, 1 turns the mode off
+     * \param width Number of nodes of each tile
+     */
+    void setTimeBlocking(unsigned int steps, unsigned int width = DEFAULT_TILE_WIDTH) {
+      block_steps_ = steps;
+      tile_width_ = width;
     }
 	
     /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
@@ -38,10 +52,15 @@ namespace marian {
      * \param L Linear operator defining PDE
      * \returns Solution in form of std::vector
      */
-    std::vector<double> solve(std::vector<double> f,
-			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-			      const std::vector<double>& time_grid,
-			      const TridiagonalOperator& L) override;
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveWithPrevious(std::vector<Real> f,
+					const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					const std::vector<double>& time_grid,
+					const BasicTridiagonalOperator<Real>& L,
+					std::vector<Real>& previous) override;
 				  
     /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
      * 
@@ -53,19 +72,46 @@ namespace marian {
      * \param file_name Name of CSV file
      * \returns Solution in form of std::vector
      */
-    std::vector<double> solveAndSave(std::vector<double> f,
-				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-				     const std::vector<double>& spatial_grid,
-				     const std::vector<double>& time_grid,
-				     const TridiagonalOperator& L,
-				     const std::string file_name) override;
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override;
 					 
     /** \brief  Returns scheme name
      */
     std::string info() const override {
       return "explicit";
     }
+  private:
+    void step(std::vector<Real>& f,
+	      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+	      double t,
+	      double dt,
+	      const BasicTridiagonalOperator<Real>& L);
+    unsigned int tiledSteps(std::vector<Real>& f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    unsigned int first,
+			    const BasicTridiagonalOperator<Real>& L);
+
+    static const unsigned int DEFAULT_TILE_WIDTH = 4096; /*!< \brief Default number of nodes of tile in temporally blocked mode*/
+
+    BasicTridiagonalOperator<Real> diff_base_;     /*!< \brief Operator \f$I + dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> diff_operator_; /*!< \brief Operator of the actual time step after applying boundary conditions*/
+    std::vector<Real> buffer_;                     /*!< \brief Buffer for solution on the next time level*/
+    double dt_ = 0.0;                              /*!< \brief Time step for which diff_base_ was assembled*/
+    unsigned int block_steps_ = 1;                 /*!< \brief Number of time steps performed for each tile in temporally blocked mode*/
+    unsigned int tile_width_ = DEFAULT_TILE_WIDTH; /*!< \brief Number of nodes of tile in temporally blocked mode*/
+    std::vector<double> low_values_;               /*!< \brief Values of Dirichlet condition on lower boundary on time levels of the block*/
+    std::vector<double> upp_values_;               /*!< \brief Values of Dirichlet condition on upper boundary on time levels of the block*/
   };
+
+  /** \ingroup schemes
+   * \brief Explicit scheme working with doubles
+   */
+  typedef BasicExplicitScheme<double> ExplicitScheme;
 } // namespace marian
 
 
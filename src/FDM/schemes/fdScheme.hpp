@@ -2,6 +2,8 @@
 #define MARIAN_FDSCHEME_HPP
 
 #include <vector>
+#include <cmath>
+#include <stdexcept>
 #include <utils/smartPointer.hpp>
 #include <FDM/tridiagonalSolver.hpp>
 #include <FDM/boundaryConditions/boundaryCondition.hpp>
@@ -28,13 +30,17 @@ namespace marian {
    * Solving this kind of system requires finding global solution. 
    * Because of that implicit scheme is numerically more demanding, but it is unconditionally stable in contrast to explicit scheme.
    * For more information see  \cite DuffyFDM \cite ClarkFx \cite MortonMayers . 
+   *
+   * Schemes are templated on the type of elements of solution and operator (\b Real), marian::FDScheme is the interface of schemes working with doubles.
+   * Grids and time are always given in doubles.
    */
-  class FDScheme {
+  template<typename Real>
+  class BasicFDScheme {
   public:
   
     /** \brief Provides a solver used in implicit scheme
 	*/
-    virtual void setSolver(const SmartPointer<TridiagonalSolver>& solver) = 0; 
+    virtual void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >& solver) = 0; 
 	/** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
 	* 
 	* \param f Initial condition 
@@ -43,10 +49,10 @@ namespace marian {
 	* \param L Linear operator defining PDE
 	* \returns Solution in form of std::vector
 	*/
-    virtual std::vector<double> solve(std::vector<double> f,
-				      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-				      const std::vector<double>& time_grid,
-				      const TridiagonalOperator& L) = 0;
+    virtual std::vector<Real> solve(std::vector<Real> f,
+				    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				    const std::vector<double>& time_grid,
+				    const BasicTridiagonalOperator<Real>& L) = 0;
 					  
 	/** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
 	* 
@@ -58,26 +64,186 @@ namespace marian {
 	* \param file_name Name of CSV file
 	* \returns Solution in form of std::vector
 	*/
-    virtual std::vector<double>  solveAndSave(std::vector<double> f,
-					      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-					      const std::vector<double>& spatial_grid,
-					      const std::vector<double>& time_grid,
-					      const TridiagonalOperator& L,
-					      const std::string file_name) = 0;
+    virtual std::vector<Real>  solveAndSave(std::vector<Real> f,
+					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					    const std::vector<double>& spatial_grid,
+					    const std::vector<double>& time_grid,
+					    const BasicTridiagonalOperator<Real>& L,
+					    const std::string file_name) = 0;
+
+	/** \brief Solves PDE defined by provided linear operator \b L for many initial conditions
+	*
+	* All problems share the operator and the time grid, only initial and boundary conditions differ 
+	* (for example options with different strikes). Default implementation solves problems one by one, 
+	* implicit schemes override it to use one factorization of tridiagonal matrix for all problems.
+	* Boundary conditions of all problems must modify the operator in the same way (like Dirichlet conditions do).
+	* 
+	* \param f Initial conditions, one vector (column) for each problem
+	* \param bcs Boundary conditions, one set for each problem
+	* \param time_grid Time grid used in
+	* \param L Linear operator defining PDE
+	* \returns Solutions, one vector for each problem
+	*/
+    virtual std::vector<std::vector<Real> > solveMany(std::vector<std::vector<Real> > f,
+						      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+						      const std::vector<double>& time_grid,
+						      const BasicTridiagonalOperator<Real>& L) {
+      for (unsigned int c = 0; c < f.size(); ++c) {
+	f[c] = solve(f[c], bcs.at(c), time_grid, L);
+      }
+      return f;
+    }
+
+
+	/** \brief Solves PDE and provides also the solution on the next to last level of time grid
+	*
+	* Solutions on the last two time levels give time derivative of the solution (e.g. theta, see FDMPricer::priceWithGreeks).
+	* Returned solution is the same as the solution returned by solve. Default implementation solves PDE on the whole time grid
+	* and on the time grid without the last level, schemes performing steps one by one record the level during single solve.
+	*
+	* \param f Initial condition
+	* \param bcs Boundary conditions
+	* \param time_grid Time grid used in
+	* \param L Linear operator defining PDE
+	* \param previous Overwritten by solution on the next to last level of time grid
+	* \returns Solution in form of std::vector
+	*/
+    virtual std::vector<Real> solveWithPrevious(std::vector<Real> f,
+						const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						const std::vector<double>& time_grid,
+						const BasicTridiagonalOperator<Real>& L,
+						std::vector<Real>& previous) {
+      if (time_grid.size() < 2) {
+	previous = f;
+	return f;
+      }
+      std::vector<double> head(time_grid.begin(), time_grid.end() - 1);
+      previous = solve(f, bcs, head, L);
+      return solve(f, bcs, time_grid, L);
+    }
+
+	/** \brief Solves PDE and computes derivatives of linear functional of the solution with respect to elements of operator (adjoint mode)
+	*
+	* Functional \f$P = w \cdot f_N\f$ of the final solution is for example the interpolated price. Schemes supporting adjoint mode
+	* record the solution on all time levels and propagate \f$w\f$ backward in time with transposed operators of the steps.
+	* Derivatives with respect to all parameters of operator are obtained from \b dL (see TridiagonalOperator::innerProduct)
+	* for the cost of about two solves, independently of number of parameters.
+	* Boundary conditions are assumed to fix the values on the rows of operator they modify (like Dirichlet conditions do).
+	*
+	* Default implementation throws std::logic_error, so schemes not supporting adjoint mode do not return zero derivatives.
+	*
+	* \param f Initial condition
+	* \param bcs Boundary conditions
+	* \param time_grid Time grid used in
+	* \param L Linear operator defining PDE
+	* \param w Weights defining functional of the final solution
+	* \param dL Overwritten by derivatives of functional with respect to elements of \b L
+	* \returns Solution in form of std::vector
+	*/
+    virtual std::vector<Real> solveAdjoint(std::vector<Real> f,
+					   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					   const std::vector<double>& time_grid,
+					   const BasicTridiagonalOperator<Real>& L,
+					   const std::vector<Real>&,
+					   BasicTridiagonalOperator<Real>&) {
+      (void)f;
+      (void)bcs;
+      (void)time_grid;
+      (void)L;
+      throw std::logic_error("Adjoint mode is not supported by scheme " + info());
+    }
 						  
+	/** \brief Performs single time step and estimates its local error with embedded error estimate
+	*
+	* Solution is advanced in place from time \b t to \b t + \b dt. Schemes providing the estimate keep the operators
+	* (and their factorizations) assembled in the previous call, so a step of the same length with the same operator
+	* does not assemble and factorize them again. Used by marian::AdaptiveScheme to choose the time steps.
+	*
+	* Default implementation throws std::logic_error, schemes without embedded error estimate do not support it.
+	*
+	* \param f Solution, overwritten by the solution at \b t + \b dt
+	* \param bcs Boundary conditions
+	* \param t Actual time
+	* \param dt Time step
+	* \param L Linear operator defining PDE
+	* \returns Estimate of local error of the step in maximum norm
+	*/
+    virtual double stepWithError(std::vector<Real>& f,
+				 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				 double t,
+				 double dt,
+				 const BasicTridiagonalOperator<Real>& L) {
+      (void)f;
+      (void)bcs;
+      (void)t;
+      (void)dt;
+      (void)L;
+      throw std::logic_error("Embedded error estimate is not supported by scheme " + info());
+    }
+
+	/** \brief Provides mass matrix \f$M\f$, so the scheme solves \f$M \frac{df}{dt} = L f\f$ (e.g. compact discretization, see compactDiscretization)
+	*
+	* Operator of size 0 removes the mass matrix. Default implementation does not support mass matrix.
+	*
+	* \param M Tridiagonal mass matrix
+	* \returns True if scheme supports mass matrix
+	*/
+    virtual bool setMassMatrix(const BasicTridiagonalOperator<Real>& M) {
+      (void)M;
+      return false;
+    }
 	/** \brief  Returns scheme name
 	*/
     virtual std::string info() const = 0;
 	
 	/** \brief  Virtual copy constructor
 	*/
-    virtual FDScheme* clone() const = 0;
+    virtual BasicFDScheme* clone() const = 0;
 	
 	/** \brief  Deconstructor
 	*/
-    virtual ~FDScheme(){};
+    virtual ~BasicFDScheme(){};
+
+    /** \brief Checks if two time steps are equal
+     *
+     * Time grids are generated by accumulating the increments, so the steps of uniform grid differ by rounding errors. 
+     * Steps are treated as equal if relative difference is below \f$10^{-10}\f$. 
+     * Schemes (also marian::BatchThetaScheme) use this check to reuse operators (and their factorizations) across segments of constant time step.
+     */
+    static bool isSameTimeStep(double dt1, double dt2) {
+      return std::fabs(dt1 - dt2) <= 1e-10 * std::fabs(dt1);
+    }
+
+  protected:
+    /** \brief Clears elements of adjoint vector on the rows fixed by boundary conditions
+     *
+     * Rows of the operator modified by boundary conditions do not depend on the operator and values on these rows
+     * are set by boundary conditions, so the solution on previous time level and the operator have no influence on them.
+     *
+     * \param base Operator of the step before applying boundary conditions
+     * \param modified Operator of the step after applying boundary conditions
+     * \param v Adjoint vector
+     */
+    static void clearFixedRows(const BasicTridiagonalOperator<Real>& base,
+			       const BasicTridiagonalOperator<Real>& modified,
+			       std::vector<Real>& v) {
+      int n = base.size();
+      for (int i = 0; i < n; ++i) {
+	bool fixed = base.mid(i) != modified.mid(i)
+	  || (i > 0 && base.low(i-1) != modified.low(i-1))
+	  || (i < n-1 && base.upp(i) != modified.upp(i));
+	if (fixed) {
+	  v[i] = 0.0;
+	}
+      }
+    }
   };
 
+  /** \ingroup schemes
+   * \brief Interface of schemes working with doubles
+   */
+  typedef BasicFDScheme<double> FDScheme;
+
   /** \ingroup schemes
    *
    * \brief Deeply copyable BoundaryCondition
@@ -90,12 +256,12 @@ namespace marian {
    *
    * For more information about virtual copy constructor see \cite joshi
    */
-  template<typename T>
-  class DCFDScheme : public FDScheme {
+  template<typename T, typename Real = double>
+  class DCFDScheme : public BasicFDScheme<Real> {
   public:
     /** \brief Virtual copy constructor
      */
-    virtual FDScheme* clone() const {
+    virtual BasicFDScheme<Real>* clone() const {
       return new T(static_cast<const T&>(*this));
     }
   };
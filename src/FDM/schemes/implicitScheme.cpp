@@ -1,4 +1,5 @@
 #include <FDM/schemes/implicitScheme.hpp>
+#include <utils/dualNumber.hpp>
 #include <utils/DataFrame.hpp>
 
 namespace marian {
@@ -10,21 +11,44 @@ namespace marian {
    * \param L Linear operator defining PDE
    * \returns Solution in form of std::vector
    */
-  std::vector<double> ImplicitScheme::solve(std::vector<double> f,
-					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-					    const std::vector<double>& time_grid,
-					    const TridiagonalOperator& L) {
-    auto I = TridiagonalOperator::I(L.size());
+  template<typename Real>
+  std::vector<Real> BasicImplicitScheme<Real>::solve(std::vector<Real> f,
+						     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						     const std::vector<double>& time_grid,
+						     const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
     for (unsigned int i = 0; i < time_grid.size()-1; i++) {
       auto dt = time_grid.at(i+1) - time_grid.at(i);
-      auto diff_operator = I - dt * L;
-      for (auto bc : bcs) {
-	bc->beforeImplicitStep(diff_operator, f,  time_grid.at(i));
-      }
-      f = solver_->solve(diff_operator, f);
-      for (auto bc : bcs) {
-	bc->afterImplicitStep(f, time_grid.at(i));
+      step(f, bcs, time_grid.at(i), dt, L);
+    }
+    return f;
+  }
+
+  /** \brief Solves PDE and provides also the solution on the next to last level of time grid
+   *
+   * Steps are performed as in solve, solution is recorded before the last step.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param previous Overwritten by solution on the next to last level of time grid
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicImplicitScheme<Real>::solveWithPrevious(std::vector<Real> f,
+								 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								 const std::vector<double>& time_grid,
+								 const BasicTridiagonalOperator<Real>& L,
+								 std::vector<Real>& previous) {
+    dt_ = 0.0;
+    previous = f;
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      if (i + 2 == time_grid.size()) {
+	previous = f;
       }
+      step(f, bcs, time_grid.at(i), dt, L);
     }
     return f;
   }
@@ -39,41 +63,201 @@ namespace marian {
    * \param file_name Name of CSV file
    * \returns Solution in form of std::vector
    */
-  std::vector<double> ImplicitScheme::solveAndSave(std::vector<double> f,
-						   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-						   const std::vector<double>& spatial_grid,
-						   const std::vector<double>& time_grid,
-						   const TridiagonalOperator& L,
-						   const std::string file_name) {
+  template<typename Real>
+  std::vector<Real> BasicImplicitScheme<Real>::solveAndSave(std::vector<Real> f,
+							    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							    const std::vector<double>& spatial_grid,
+							    const std::vector<double>& time_grid,
+							    const BasicTridiagonalOperator<Real>& L,
+							    const std::string file_name) {
     DataFrame df;
     for (unsigned int i = 0; i < f.size(); i++) {
       DataEntryClerk input;
       input.add("T", time_grid.front());
       input.add("S", spatial_grid.at(i));
-      input.add("f", f.at(i));
+      input.add("f", static_cast<double>(f.at(i)));
       df.append(input);
     }
     
-    auto I = TridiagonalOperator::I(L.size());
+    dt_ = 0.0;
     for (unsigned int i = 0; i < time_grid.size()-1; i++) {
       auto dt = time_grid.at(i+1) - time_grid.at(i);
-      auto diff_operator = I - dt * L;
-      for (auto bc : bcs) {
-	bc->beforeImplicitStep(diff_operator, f, time_grid.at(i));
-      }
-      f = solver_->solve(diff_operator, f);
-      for (auto bc : bcs) {
-	bc->afterImplicitStep(f, time_grid.at(i));
-      }
+      step(f, bcs, time_grid.at(i), dt, L);
       for (unsigned int j = 0; j < f.size(); j++) {
 	DataEntryClerk input;
 	input.add("T", time_grid.at(i+1));
 	input.add("S", spatial_grid.at(j));
-	input.add("f", f.at(j));
+	input.add("f", static_cast<double>(f.at(j)));
 	df.append(input);
       }
     }
     df.printToCsv(file_name,';');
     return f;
   }
+
+  /** \brief Performs single implicit step
+   *
+   * Operator \f$I - dt L\f$ is assembled only when the time step changes (see assemble). 
+   * The factorization of the operator is reused as long as the operator modified by boundary conditions stays the same,
+   * so for uniform time grid the tridiagonal matrix is factorized only once. The system is solved in place, without allocating memory.
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicImplicitScheme<Real>::step(std::vector<Real>& f,
+				       const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				       double t,
+				       double dt,
+				       const BasicTridiagonalOperator<Real>& L) {
+    assemble(dt, L);
+    diff_operator_ = diff_base_;
+    for (auto bc : bcs) {
+      bc->beforeImplicitStep(diff_operator_, f, t);
+    }
+    if (!solver_->isFactorized(diff_operator_)) {
+      solver_->factorize(diff_operator_);
+    }
+    solver_->solveFactorized(f, f);
+    for (auto bc : bcs) {
+      bc->afterImplicitStep(f, t);
+    }
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L for many initial conditions
+   *
+   * All problems are stepped together. In each time step the operator is factorized at most once 
+   * and the systems of all problems are solved with multi-column substitution (see TridiagonalSolver::solveFactorized).
+   * 
+   * \param f Initial conditions, one vector (column) for each problem
+   * \param bcs Boundary conditions, one set for each problem
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solutions, one vector for each problem
+   */
+  template<typename Real>
+  std::vector<std::vector<Real> > BasicImplicitScheme<Real>::solveMany(std::vector<std::vector<Real> > f,
+								       const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+								       const std::vector<double>& time_grid,
+								       const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      stepMany(f, bcs, time_grid.at(i), dt, L);
+    }
+    return f;
+  }
+
+  /** \brief Performs single implicit step for many problems
+   *
+   * Boundary conditions of all problems are applied to the same operator. Systems are solved in place.
+   *
+   * \param f Solutions, overwritten by solutions on the next time level
+   * \param bcs Boundary conditions, one set for each problem
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicImplicitScheme<Real>::stepMany(std::vector<std::vector<Real> >& f,
+					   const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+					   double t,
+					   double dt,
+					   const BasicTridiagonalOperator<Real>& L) {
+    assemble(dt, L);
+    diff_operator_ = diff_base_;
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      for (auto bc : bcs.at(c)) {
+	bc->beforeImplicitStep(diff_operator_, f[c], t);
+      }
+    }
+    if (!solver_->isFactorized(diff_operator_)) {
+      solver_->factorize(diff_operator_);
+    }
+    solver_->solveFactorized(f);
+    for (unsigned int c = 0; c < f.size(); ++c) {
+      for (auto bc : bcs.at(c)) {
+	bc->afterImplicitStep(f[c], t);
+      }
+    }
+  }
+
+  /** \brief Solves PDE and computes derivatives of functional \f$w \cdot f_N\f$ with respect to elements of operator \b L
+   *
+   * Solution is recorded on all time levels. Going backward in time, the adjoint vector \f$\lambda_N = w\f$ is propagated by:
+   * \f[ (I - dt L)^T \lambda_{n-1} = \lambda_n \f]
+   * (operator is modified by boundary conditions, elements of \f$\lambda_{n-1}\f$ on the fixed rows are cleared)
+   * and the derivatives are accumulated as \f$\partial P/\partial L_{ij} = \sum_n dt \lambda_{n-1,i} f_{n,j}\f$.
+   * Transposed systems are solved by copy of the solver, so its factorization is reused for uniform time grid.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param w Weights defining functional of the final solution
+   * \param dL Overwritten by derivatives of functional with respect to elements of \b L
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicImplicitScheme<Real>::solveAdjoint(std::vector<Real> f,
+							    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							    const std::vector<double>& time_grid,
+							    const BasicTridiagonalOperator<Real>& L,
+							    const std::vector<Real>& w,
+							    BasicTridiagonalOperator<Real>& dL) {
+    unsigned int steps = time_grid.size() - 1;
+    std::vector<std::vector<Real> > levels;
+    levels.reserve(steps + 1);
+    levels.push_back(f);
+    dt_ = 0.0;
+    for (unsigned int i = 0; i < steps; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      step(f, bcs, time_grid.at(i), dt, L);
+      levels.push_back(f);
+    }
+
+    SmartPointer<BasicTridiagonalSolver<Real> > adjoint_solver = solver_;
+    std::vector<Real> lambda(w);
+    std::vector<Real> scratch(f.size());
+    dL = BasicTridiagonalOperator<Real>(L.size());
+    for (unsigned int i = steps; i > 0; i--) {
+      auto t = time_grid.at(i-1);
+      auto dt = time_grid.at(i) - t;
+      assemble(dt, L);
+      diff_operator_ = diff_base_;
+      for (auto bc : bcs) {
+	bc->beforeImplicitStep(diff_operator_, scratch, t);
+      }
+
+      auto transposed = diff_operator_.transpose();
+      if (!adjoint_solver->isFactorized(transposed)) {
+	adjoint_solver->factorize(transposed);
+      }
+      adjoint_solver->solveFactorized(lambda, lambda);
+      this->clearFixedRows(diff_base_, diff_operator_, lambda);
+      dL.addOuterProduct(dt, lambda, levels[i]);
+    }
+    return f;
+  }
+
+  /** \brief Assembles operator \f$I - dt L\f$ if time step has changed
+   *
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicImplicitScheme<Real>::assemble(double dt, const BasicTridiagonalOperator<Real>& L) {
+    if (!this->isSameTimeStep(dt, dt_)) {
+      diff_base_ = BasicTridiagonalOperator<Real>::I(L.size()) - dt * L;
+      dt_ = dt;
+    }
+  }
+
+  // instantiations for supported types of elements
+  template class BasicImplicitScheme<double>;
+  template class BasicImplicitScheme<float>;
+  template class BasicImplicitScheme<Dual>;
 }  // namespace fdm
@@ -20,35 +20,71 @@ namespace marian {
    \f]
    * For more information see  \cite DuffyFDM \cite ClarkFx \cite MortonMayers . 
    */
-  class ImplicitScheme : public DCFDScheme<ImplicitScheme> {
+  template<typename Real>
+  class BasicImplicitScheme : public DCFDScheme<BasicImplicitScheme<Real>, Real> {
   public:
     /** \brief defualt constructor
      */
-    ImplicitScheme(){};
+    BasicImplicitScheme(){};
 
     /** \brief constructor
      */
-    ImplicitScheme(SmartPointer<TridiagonalSolver> solver): solver_(solver) {};
-    void setSolver(const SmartPointer<TridiagonalSolver>& solver) override {
+    BasicImplicitScheme(SmartPointer<BasicTridiagonalSolver<Real> > solver): solver_(solver) {};
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >& solver) override {
       solver_ = solver;
     }
-    std::vector<double> solve(std::vector<double> f,
-			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-			      const std::vector<double>& time_grid,
-			      const TridiagonalOperator& L)  override;
-    std::vector<double> solveAndSave(std::vector<double> f,
-				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
-				     const std::vector<double>& spatial_grid,
-				     const std::vector<double>& time_grid,
-				     const TridiagonalOperator& L,
-				     const std::string file_name) override;
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L)  override;
+    std::vector<Real> solveWithPrevious(std::vector<Real> f,
+					const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					const std::vector<double>& time_grid,
+					const BasicTridiagonalOperator<Real>& L,
+					std::vector<Real>& previous) override;
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override;
+    std::vector<std::vector<Real> > solveMany(std::vector<std::vector<Real> > f,
+					      const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+					      const std::vector<double>& time_grid,
+					      const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveAdjoint(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::vector<Real>& w,
+				   BasicTridiagonalOperator<Real>& dL) override;
     std::string info() const override {
       return "implicit";
     }
   private:
-    SmartPointer<TridiagonalSolver> solver_; /*!< \brief Sovler used in implicit step*/ 
+    void step(std::vector<Real>& f,
+	      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+	      double t,
+	      double dt,
+	      const BasicTridiagonalOperator<Real>& L);
+    void stepMany(std::vector<std::vector<Real> >& f,
+		  const std::vector<std::vector<SmartPointer<BoundaryCondition> > >& bcs,
+		  double t,
+		  double dt,
+		  const BasicTridiagonalOperator<Real>& L);
+    void assemble(double dt, const BasicTridiagonalOperator<Real>& L);
+
+    SmartPointer<BasicTridiagonalSolver<Real> > solver_; /*!< \brief Sovler used in implicit step*/
+    BasicTridiagonalOperator<Real> diff_base_;           /*!< \brief Operator \f$I - dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> diff_operator_;       /*!< \brief Operator of the actual time step after applying boundary conditions*/
+    double dt_ = 0.0;                                    /*!< \brief Time step for which diff_base_ was assembled*/
   };
 
+  /** \ingroup schemes
+   * \brief Implicit scheme working with doubles
+   */
+  typedef BasicImplicitScheme<double> ImplicitScheme;
+
 } // namespace marian
 
 #endif /* MARIAN_IMPLICITSCHEME_HPP */
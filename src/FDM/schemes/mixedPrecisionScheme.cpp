@@ -0,0 +1,102 @@
+#include <FDM/schemes/mixedPrecisionScheme.hpp>
+#include <algorithm>
+#include <utils/dataFrame.hpp>
+
+namespace marian {
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * Operator and initial condition are converted to floats and solved on the time grid without last double_steps_ points,
+   * the trailing steps are solved in doubles.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> MixedPrecisionScheme::solve(std::vector<double> f,
+						  const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						  const std::vector<double>& time_grid,
+						  const TridiagonalOperator& L) {
+    unsigned int steps = time_grid.size() - 1;
+    unsigned int split = steps - std::min(double_steps_, steps);
+    if (split > 0) {
+      BasicTridiagonalOperator<float> low_L(L);
+      std::vector<double> low_grid(time_grid.begin(), time_grid.begin() + split + 1);
+      f = solveLowPrecision(f, bcs, low_grid, low_L);
+    }
+    if (split < steps) {
+      std::vector<double> double_grid(time_grid.begin() + split, time_grid.end());
+      f = double_scheme_->solve(f, bcs, double_grid, L);
+    }
+    return f;
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
+   *
+   * Schemes are called for each time step separately, so the solution on every time level can be saved.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Time grid used for time dimension of FDM
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> MixedPrecisionScheme::solveAndSave(std::vector<double> f,
+							 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							 const std::vector<double>& spatial_grid,
+							 const std::vector<double>& time_grid,
+							 const TridiagonalOperator& L,
+							 const std::string file_name) {
+    DataFrame df;
+    for (unsigned int i = 0; i < f.size(); i++) {
+      DataEntryClerk input;
+      input.add("T", time_grid.front());
+      input.add("S", spatial_grid.at(i));
+      input.add("f", f.at(i));
+      df.append(input);
+    }
+
+    unsigned int steps = time_grid.size() - 1;
+    unsigned int split = steps - std::min(double_steps_, steps);
+    BasicTridiagonalOperator<float> low_L(L);
+    for (unsigned int i = 0; i < steps; i++) {
+      std::vector<double> step_grid {time_grid.at(i), time_grid.at(i+1)};
+      if (i < split) {
+	f = solveLowPrecision(f, bcs, step_grid, low_L);
+      } else {
+	f = double_scheme_->solve(f, bcs, step_grid, L);
+      }
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", time_grid.at(i+1));
+	input.add("S", spatial_grid.at(j));
+	input.add("f", f.at(j));
+	df.append(input);
+      }
+    }
+    df.printToCsv(file_name,';');
+    return f;
+  }
+
+  /** \brief Converts solution to floats, solves PDE with scheme working with floats and converts the result back to doubles
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE (in floats)
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> MixedPrecisionScheme::solveLowPrecision(const std::vector<double>& f,
+							      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							      const std::vector<double>& time_grid,
+							      const BasicTridiagonalOperator<float>& L) {
+    std::vector<float> low_f(f.begin(), f.end());
+    low_f = scheme_->solve(low_f, bcs, time_grid, L);
+    return std::vector<double>(low_f.begin(), low_f.end());
+  }
+
+}  // namespace marian
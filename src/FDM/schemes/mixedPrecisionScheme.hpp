@@ -0,0 +1,65 @@
+#ifndef MARIAN_MIXEDPRECISIONSCHEME_HPP
+#define MARIAN_MIXEDPRECISIONSCHEME_HPP
+
+#include <FDM/schemes/fdScheme.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements scheme solving PDE in single precision with trailing time steps in double precision
+   *
+   * Scheme performs all but the last few time steps with the scheme working with floats (for example BasicCrankNicolsonScheme<float>),
+   * which halves the memory traffic and doubles the number of elements processed by single SIMD instruction.
+   * The solution is then converted to doubles and the trailing steps are performed by the scheme working with doubles.
+   *
+   * Trailing steps do not correct the solution: its accuracy is that of the single precision solution (relative error of order \f$10^{-7}\f$).
+   * Rounding errors of single precision are not smooth, so they are strongly amplified by finite difference formulas
+   * (e.g. when greeks are calculated from the solution). Trailing steps with scheme damping high frequencies (e.g. implicit scheme)
+   * smooth the rounding errors, so the finite differences of the final solution are not dominated by them.
+   *
+   * Scheme working with floats should be constructed with its own solver, setSolver provides the solver to the scheme working with doubles.
+   */
+  class MixedPrecisionScheme : public DCFDScheme<MixedPrecisionScheme> {
+  public:
+    /** \brief Constructor
+     *
+     * \param scheme Scheme working with floats
+     * \param double_scheme Scheme working with doubles used in trailing steps
+     * \param double_steps Number of trailing steps performed in double precision
+     */
+    MixedPrecisionScheme(SmartPointer<BasicFDScheme<float> > scheme,
+			 SmartPointer<FDScheme> double_scheme,
+			 unsigned int double_steps = 1):
+      scheme_(scheme), double_scheme_(double_scheme), double_steps_(double_steps) {};
+
+    /** \brief Provides a solver used in trailing steps
+     */
+    void setSolver(const SmartPointer<TridiagonalSolver>& solver) override {
+      double_scheme_->setSolver(solver);
+    }
+    std::vector<double> solve(std::vector<double> f,
+			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			      const std::vector<double>& time_grid,
+			      const TridiagonalOperator& L) override;
+    std::vector<double> solveAndSave(std::vector<double> f,
+				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				     const std::vector<double>& spatial_grid,
+				     const std::vector<double>& time_grid,
+				     const TridiagonalOperator& L,
+				     const std::string file_name) override;
+    std::string info() const override {
+      return "MixedPrecision " + scheme_->info() + "/" + double_scheme_->info();
+    }
+  private:
+    std::vector<double> solveLowPrecision(const std::vector<double>& f,
+					  const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					  const std::vector<double>& time_grid,
+					  const BasicTridiagonalOperator<float>& L);
+
+    SmartPointer<BasicFDScheme<float> > scheme_; /*!< \brief Scheme working with floats*/
+    SmartPointer<FDScheme> double_scheme_;       /*!< \brief Scheme working with doubles used in trailing steps*/
+    unsigned int double_steps_;                  /*!< \brief Number of trailing steps performed in double precision*/
+  };
+
+} // namespace marian
+
+#endif /* MARIAN_MIXEDPRECISIONSCHEME_HPP */
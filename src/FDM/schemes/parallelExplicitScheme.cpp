@@ -0,0 +1,147 @@
+#include <FDM/schemes/parallelExplicitScheme.hpp>
+#include <algorithm>
+#include <utils/dualNumber.hpp>
+
+namespace marian {
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * Number of threads is reduced, so every chunk has at least MIN_CHUNK nodes. If single chunk remains or some boundary condition
+   * is not Dirichlet condition, PDE is solved by sequential explicit scheme.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicParallelExplicitScheme<Real>::solve(std::vector<Real> f,
+							     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							     const std::vector<double>& time_grid,
+							     const BasicTridiagonalOperator<Real>& L) {
+    unsigned int n = f.size();
+    unsigned int threads = std::max(1u, std::min(threads_, n / MIN_CHUNK));
+    bool dirichlet = true;
+    for (auto& bc : bcs) {
+      BCSide side;
+      dirichlet = dirichlet && bc->isDirichlet(side);
+    }
+    if (threads == 1 || !dirichlet) {
+      return sequential_.solve(f, bcs, time_grid, L);
+    }
+
+    // vectors of chunks are allocated by the threads
+    chunks_.assign(threads, Chunk());
+    for (unsigned int k = 0; k < threads; ++k) {
+      chunks_[k].begin = static_cast<unsigned long>(n) * k / threads;
+      chunks_[k].end = static_cast<unsigned long>(n) * (k + 1) / threads;
+    }
+    Barrier barrier(threads);
+    pool_.run(threads, [&](unsigned int k) {
+	solveChunk(k, f, bcs, time_grid, L, barrier);
+      });
+    return f;
+  }
+
+  /** \brief Performs all time steps on single chunk (executed by thread owning the chunk)
+   *
+   * Thread allocates and initializes vectors of its chunk (first touch), clones boundary conditions set on the boundary
+   * belonging to the chunk and waits until all chunks are initialized. In each step it reads the values of neighbouring nodes
+   * from the actual level of neighbouring chunks, writes the next level of its own chunk and waits at the barrier.
+   * Finally the solution on chunk is copied to \b f.
+   *
+   * Boundary conditions are not called on the vectors of chunks, which hold only part of the grid. Chunk owning the first (last) node
+   * of the grid sets it to BoundaryCondition::dirichletValue of the low (upper) condition, as Dirichlet condition does after explicit step.
+   *
+   * Chunks have at least MIN_CHUNK nodes, so the first and the last node of chunk are different nodes.
+   * Operator \f$I + dt L\f$ is assembled only when the time step changes, in the same way as in marian::BasicExplicitScheme.
+   * Rows of nodes fixed by Dirichlet conditions are not modified, the values are overwritten by the conditions after the step.
+   *
+   * \param k Index of chunk
+   * \param f Initial condition, overwritten on the chunk by the solution
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \param barrier Barrier synchronizing the threads after each step
+   */
+  template<typename Real>
+  void BasicParallelExplicitScheme<Real>::solveChunk(unsigned int k,
+						     std::vector<Real>& f,
+						     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						     const std::vector<double>& time_grid,
+						     const BasicTridiagonalOperator<Real>& L,
+						     Barrier& barrier) {
+    Chunk& chunk = chunks_[k];
+    unsigned int n = f.size();
+    unsigned int size = chunk.end - chunk.begin;
+    bool first = k == 0;
+    bool last = k + 1 == chunks_.size();
+
+    chunk.low.resize(size);
+    chunk.mid.resize(size);
+    chunk.upp.resize(size);
+    for (unsigned int j = 0; j < size; ++j) {
+      unsigned int i = chunk.begin + j;
+      chunk.low[j] = i > 0 ? L.evalLow(i-1) : Real(0.0);
+      chunk.mid[j] = L.evalMid(i);
+      chunk.upp[j] = i + 1 < n ? L.evalUpp(i) : Real(0.0);
+    }
+    chunk.diff_low.resize(size);
+    chunk.diff_mid.resize(size);
+    chunk.diff_upp.resize(size);
+    chunk.levels[0].assign(f.begin() + chunk.begin, f.begin() + chunk.end);
+    chunk.levels[1].resize(size);
+
+    std::vector<SmartPointer<BoundaryCondition> > low_bcs;
+    std::vector<SmartPointer<BoundaryCondition> > upp_bcs;
+    for (auto& bc : bcs) {
+      // solve checked that all conditions are Dirichlet conditions
+      BCSide side;
+      bc->isDirichlet(side);
+      if (side == BCSide::LOW && first) {
+	low_bcs.push_back(bc);
+      } else if (side == BCSide::UPP && last) {
+	upp_bcs.push_back(bc);
+      }
+    }
+    barrier.wait();
+
+    double chunk_dt = 0.0;
+    unsigned int steps = time_grid.size() - 1;
+    for (unsigned int i = 0; i < steps; ++i) {
+      double dt = time_grid.at(i+1) - time_grid.at(i);
+      if (!this->isSameTimeStep(dt, chunk_dt)) {
+	Real scale = dt;
+	for (unsigned int j = 0; j < size; ++j) {
+	  chunk.diff_low[j] = scale * chunk.low[j];
+	  chunk.diff_mid[j] = Real(1.0) + scale * chunk.mid[j];
+	  chunk.diff_upp[j] = scale * chunk.upp[j];
+	}
+	chunk_dt = dt;
+      }
+
+      const std::vector<Real>& u = chunk.levels[i % 2];
+      std::vector<Real>& v = chunk.levels[(i + 1) % 2];
+      Real left = first ? Real(0.0) : chunks_[k-1].levels[i % 2].back();
+      Real right = last ? Real(0.0) : chunks_[k+1].levels[i % 2].front();
+      v[0] = chunk.diff_low[0] * left + chunk.diff_mid[0] * u[0] + chunk.diff_upp[0] * u[1];
+      for (unsigned int j = 1; j < size - 1; ++j) {
+	v[j] = chunk.diff_low[j] * u[j-1] + chunk.diff_mid[j] * u[j] + chunk.diff_upp[j] * u[j+1];
+      }
+      v[size-1] = chunk.diff_low[size-1] * u[size-2] + chunk.diff_mid[size-1] * u[size-1] + chunk.diff_upp[size-1] * right;
+      for (auto& bc : low_bcs) {
+	v[0] = bc->dirichletValue(time_grid.at(i));
+      }
+      for (auto& bc : upp_bcs) {
+	v[size-1] = bc->dirichletValue(time_grid.at(i));
+      }
+      barrier.wait();
+    }
+    std::copy(chunk.levels[steps % 2].begin(), chunk.levels[steps % 2].end(), f.begin() + chunk.begin);
+  }
+
+  // instantiations for supported types of elements
+  template class BasicParallelExplicitScheme<double>;
+  template class BasicParallelExplicitScheme<float>;
+  template class BasicParallelExplicitScheme<Dual>;
+}  // namespace marian
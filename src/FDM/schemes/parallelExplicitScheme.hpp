@@ -0,0 +1,101 @@
+#ifndef MARIAN_PARALLELEXPLICITSCHEME_HPP
+#define MARIAN_PARALLELEXPLICITSCHEME_HPP
+
+#include <thread>
+#include <FDM/schemes/explicitScheme.hpp>
+#include <utils/parallel.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements explicit scheme performing time steps on many threads (domain decomposition)
+   *
+   * Grid is divided into contiguous chunks, one for each thread. Each thread keeps its part of the operator \f$I + dt L\f$
+   * and two time levels of its part of the solution in its own vectors. Vectors are allocated and initialized by the owning thread,
+   * so on NUMA machines they are placed in the memory of the node running the thread (first-touch policy).
+   *
+   * In each time step the thread reads single value from each neighbouring chunk (halo), computes its part of the next time level
+   * and waits at the barrier. Levels are stored alternately in two vectors, so the values read by the neighbours
+   * are not overwritten before the barrier and single barrier per step is sufficient.
+   *
+   * Threads owning the first and the last node of the grid set the boundary values of Dirichlet conditions
+   * (see BoundaryCondition::isDirichlet and BoundaryCondition::dirichletValue). Other conditions need the whole solution vector,
+   * so for them, for small grids and for solveAndSave the scheme performs sequential steps of marian::BasicExplicitScheme.
+   * Results are identical to the results of marian::BasicExplicitScheme.
+   *
+   * Threads are started by the first solve and reused by the next solves (see WorkerPool), they are restarted only
+   * if the number of chunks changes. Single barrier per step limits the gain to grids of \f$10^5\f$ nodes and more.
+   */
+  template<typename Real>
+  class BasicParallelExplicitScheme : public DCFDScheme<BasicParallelExplicitScheme<Real>, Real> {
+  public:
+    /** \brief Constructor
+     *
+     * \param threads Number of threads (chunks) used by scheme, by default number of hardware threads
+     */
+    explicit BasicParallelExplicitScheme(unsigned int threads = std::thread::hardware_concurrency()):
+      threads_(threads > 0 ? threads : 1) {};
+
+    /** \brief Provides a solver used in implicit scheme.
+     *
+     * For explicit method this method is empty.
+     */
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >&) override {
+    }
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L) override;
+
+    /** \brief Solves PDE and saves solution to CSV file
+     *
+     * Solution on every time level is gathered to save it, so the steps are performed sequentially.
+     */
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override {
+      return sequential_.solveAndSave(f, bcs, spatial_grid, time_grid, L, file_name);
+    }
+    std::string info() const override {
+      return "explicit parallel(" + std::to_string(threads_) + ")";
+    }
+  private:
+    /** \brief Data of single chunk of the grid owned by one thread
+     */
+    struct Chunk {
+      unsigned int begin;            /*!< \brief First node of chunk*/
+      unsigned int end;              /*!< \brief End of chunk (one past the last node)*/
+      std::vector<Real> low;         /*!< \brief Elements of operator L coupling nodes with left neighbours*/
+      std::vector<Real> mid;         /*!< \brief Diagonal of operator L*/
+      std::vector<Real> upp;         /*!< \brief Elements of operator L coupling nodes with right neighbours*/
+      std::vector<Real> diff_low;    /*!< \brief Elements of operator \f$I + dt L\f$ coupling nodes with left neighbours*/
+      std::vector<Real> diff_mid;    /*!< \brief Diagonal of operator \f$I + dt L\f$*/
+      std::vector<Real> diff_upp;    /*!< \brief Elements of operator \f$I + dt L\f$ coupling nodes with right neighbours*/
+      std::vector<Real> levels[2];   /*!< \brief Solution on chunk on two consecutive time levels*/
+    };
+
+    void solveChunk(unsigned int k,
+		    std::vector<Real>& f,
+		    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+		    const std::vector<double>& time_grid,
+		    const BasicTridiagonalOperator<Real>& L,
+		    Barrier& barrier);
+
+    static const unsigned int MIN_CHUNK = 4096; /*!< \brief Minimal number of nodes in chunk*/
+
+    unsigned int threads_;                   /*!< \brief Maximal number of threads*/
+    std::vector<Chunk> chunks_;              /*!< \brief Chunks of the grid, one for each thread*/
+    BasicExplicitScheme<Real> sequential_;   /*!< \brief Scheme used when steps can not be performed in parallel*/
+    WorkerPool pool_;                        /*!< \brief Threads performing steps on chunks*/
+  };
+
+  /** \ingroup schemes
+   * \brief Parallel explicit scheme working with doubles
+   */
+  typedef BasicParallelExplicitScheme<double> ParallelExplicitScheme;
+
+} // namespace marian
+
+#endif /* MARIAN_PARALLELEXPLICITSCHEME_HPP */
@@ -0,0 +1,124 @@
+#include <FDM/schemes/pararealScheme.hpp>
+#include <algorithm>
+#include <utils/parallel.hpp>
+#include <utils/dataFrame.hpp>
+
+namespace marian {
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used by fine scheme
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> PararealScheme::solve(std::vector<double> f,
+					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					    const std::vector<double>& time_grid,
+					    const TridiagonalOperator& L) {
+    std::vector<unsigned int> boundaries;
+    return solveSlices(f, bcs, time_grid, L, boundaries).back();
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
+   *
+   * Solution is saved on the boundaries of time slices only (solutions inside slices are not gathered from the fine solves).
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Time grid used by fine scheme
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> PararealScheme::solveAndSave(std::vector<double> f,
+						   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						   const std::vector<double>& spatial_grid,
+						   const std::vector<double>& time_grid,
+						   const TridiagonalOperator& L,
+						   const std::string file_name) {
+    std::vector<unsigned int> boundaries;
+    auto solutions = solveSlices(f, bcs, time_grid, L, boundaries);
+    DataFrame df;
+    for (unsigned int k = 0; k < solutions.size(); k++) {
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", time_grid.at(boundaries[k]));
+	input.add("S", spatial_grid.at(j));
+	input.add("f", solutions[k][j]);
+	df.append(input);
+      }
+    }
+    df.printToCsv(file_name,';');
+    return solutions.back();
+  }
+
+  /** \brief Performs Parareal iterations
+   *
+   * Slices contain equal numbers of steps of time grid. In iteration \f$i\f$ fine solves are performed only for slices
+   * \f$k \ge i\f$, because the earlier slices have already converged to the fine solution.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used by fine scheme
+   * \param L Linear operator defining PDE
+   * \param boundaries Overwritten by indices of points of time grid bounding the slices
+   * \returns Solutions on the boundaries of slices (the first is the initial condition)
+   */
+  std::vector<std::vector<double> > PararealScheme::solveSlices(const std::vector<double>& f,
+								const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								const std::vector<double>& time_grid,
+								const TridiagonalOperator& L,
+								std::vector<unsigned int>& boundaries) {
+    unsigned int steps = time_grid.size() - 1;
+    unsigned int slices = std::min(slices_, steps);
+    boundaries.resize(slices + 1);
+    for (unsigned int k = 0; k <= slices; k++) {
+      boundaries[k] = static_cast<unsigned long>(steps) * k / slices;
+    }
+    auto coarse = [&](const std::vector<double>& u, unsigned int k) {
+      std::vector<double> slice_grid {time_grid.at(boundaries[k]), time_grid.at(boundaries[k+1])};
+      return coarse_->solve(u, bcs, slice_grid, L);
+    };
+
+    // initial coarse sweep
+    std::vector<std::vector<double> > solutions(slices + 1);
+    std::vector<std::vector<double> > coarse_solutions(slices);
+    std::vector<std::vector<double> > fine_solutions(slices);
+    solutions[0] = f;
+    for (unsigned int k = 0; k < slices; k++) {
+      coarse_solutions[k] = coarse(solutions[k], k);
+      solutions[k+1] = coarse_solutions[k];
+    }
+
+    std::vector<SmartPointer<FDScheme> > fines(slices, fine_);
+    corrections_.clear();
+    for (unsigned int first = 0; first < std::min(max_iterations_, slices); first++) {
+      workStealingFor(slices - first, slices - first, [&](unsigned int thread, unsigned int i) {
+	  unsigned int k = first + i;
+	  std::vector<double> slice_grid(time_grid.begin() + boundaries[k], time_grid.begin() + boundaries[k+1] + 1);
+	  fine_solutions[k] = fines[thread]->solve(solutions[k], bcs, slice_grid, L);
+	});
+
+      // sequential coarse sweep correcting the solutions
+      double change = 0.0;
+      for (unsigned int k = first; k < slices; k++) {
+	auto predicted = coarse(solutions[k], k);
+	for (unsigned int j = 0; j < f.size(); j++) {
+	  double corrected = predicted[j] + fine_solutions[k][j] - coarse_solutions[k][j];
+	  change = std::max(change, std::fabs(corrected - solutions[k+1][j]));
+	  solutions[k+1][j] = corrected;
+	}
+	coarse_solutions[k].swap(predicted);
+      }
+      corrections_.push_back(change);
+      if (change <= tolerance_) {
+	break;
+      }
+    }
+    return solutions;
+  }
+
+}  // namespace marian
@@ -0,0 +1,88 @@
+#ifndef MARIAN_PARAREALSCHEME_HPP
+#define MARIAN_PARAREALSCHEME_HPP
+
+#include <thread>
+#include <FDM/schemes/fdScheme.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements Parareal algorithm solving PDE in parallel in time
+   *
+   * Time grid is divided into \f$K\f$ slices \f$[T_k, T_{k+1}]\f$. Coarse propagator \f$G\f$ (coarse scheme performing single step
+   * over the slice, e.g. implicit scheme) is cheap but inaccurate, fine propagator \f$F\f$ (fine scheme solving the slice on the points of
+   * time grid) is accurate. Starting from the coarse solution \f$U^0_{k+1} = G(U^0_k)\f$, iteration \f$i\f$ corrects the solution by:
+   * \f[ U^{i+1}_{k+1} = G(U^{i+1}_k) + F(U^i_k) - G(U^i_k) \f]
+   * Fine solves of all slices are independent, so they are performed concurrently, each thread with its own copy of fine scheme.
+   * Only the cheap coarse sweep is sequential. After iteration \f$i\f$ the first \f$i\f$ slices are equal to the fine solution,
+   * so the algorithm converges in at most \f$K\f$ iterations. Iterations stop when the maximal change of the solution
+   * on slice boundaries is below tolerance. Number of iterations and the changes of the last solve are available by
+   * getIterations and getCorrections.
+   *
+   * Speed-up is bounded by \f$K / (\text{iterations} + 1)\f$, so Parareal pays off for long time horizons solved with
+   * many threads, when the coarse propagator captures the slowly varying solution well (e.g. Fokker-Planck equation).
+   */
+  class PararealScheme : public DCFDScheme<PararealScheme> {
+  public:
+    /** \brief Constructor
+     *
+     * \param coarse Scheme of coarse propagator, performs single step over time slice
+     * \param fine Scheme of fine propagator, solves the slice on points of time grid
+     * \param slices Number of time slices, by default number of hardware threads
+     * \param tolerance Maximal change of solution on slice boundaries at convergence
+     * \param max_iterations Maximal number of iterations
+     */
+    PararealScheme(SmartPointer<FDScheme> coarse,
+		   SmartPointer<FDScheme> fine,
+		   unsigned int slices = std::thread::hardware_concurrency(),
+		   double tolerance = 1e-8,
+		   unsigned int max_iterations = 10):
+      coarse_(coarse), fine_(fine), slices_(slices > 0 ? slices : 1), tolerance_(tolerance), max_iterations_(max_iterations) {};
+
+    /** \brief Provides a solver used by coarse and fine scheme
+     */
+    void setSolver(const SmartPointer<TridiagonalSolver>& solver) override {
+      coarse_->setSolver(solver);
+      fine_->setSolver(solver);
+    }
+    std::vector<double> solve(std::vector<double> f,
+			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			      const std::vector<double>& time_grid,
+			      const TridiagonalOperator& L) override;
+    std::vector<double> solveAndSave(std::vector<double> f,
+				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				     const std::vector<double>& spatial_grid,
+				     const std::vector<double>& time_grid,
+				     const TridiagonalOperator& L,
+				     const std::string file_name) override;
+    std::string info() const override {
+      return "Parareal " + coarse_->info() + "/" + fine_->info();
+    }
+
+    /** \brief Returns number of iterations of the last solve
+     */
+    unsigned int getIterations() const {
+      return corrections_.size();
+    }
+    /** \brief Returns maximal change of solution on slice boundaries in each iteration of the last solve
+     */
+    const std::vector<double>& getCorrections() const {
+      return corrections_;
+    }
+  private:
+    std::vector<std::vector<double> > solveSlices(const std::vector<double>& f,
+						  const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						  const std::vector<double>& time_grid,
+						  const TridiagonalOperator& L,
+						  std::vector<unsigned int>& boundaries);
+
+    SmartPointer<FDScheme> coarse_;   /*!< \brief Scheme of coarse propagator*/
+    SmartPointer<FDScheme> fine_;     /*!< \brief Scheme of fine propagator*/
+    unsigned int slices_;             /*!< \brief Number of time slices*/
+    double tolerance_;                /*!< \brief Maximal change of solution on slice boundaries at convergence*/
+    unsigned int max_iterations_;     /*!< \brief Maximal number of iterations*/
+    std::vector<double> corrections_; /*!< \brief Maximal change of solution in each iteration of the last solve*/
+  };
+
+} // namespace marian
+
+#endif /* MARIAN_PARAREALSCHEME_HPP */
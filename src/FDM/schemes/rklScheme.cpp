@@ -0,0 +1,186 @@
+#include <FDM/schemes/rklScheme.hpp>
+#include <algorithm>
+#include <utils/dualNumber.hpp>
+#include <utils/dataFrame.hpp>
+
+namespace marian {
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicRKL2Scheme<Real>::solve(std::vector<Real> f,
+						 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						 const std::vector<double>& time_grid,
+						 const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      step(f, bcs, time_grid.at(i), dt, L);
+    }
+    return f;
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Time grid used for time dimension of FDM
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicRKL2Scheme<Real>::solveAndSave(std::vector<Real> f,
+							const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							const std::vector<double>& spatial_grid,
+							const std::vector<double>& time_grid,
+							const BasicTridiagonalOperator<Real>& L,
+							const std::string file_name) {
+    DataFrame df;
+    for (unsigned int i = 0; i < f.size(); i++) {
+      DataEntryClerk input;
+      input.add("T", time_grid.front());
+      input.add("S", spatial_grid.at(i));
+      input.add("f", static_cast<double>(f.at(i)));
+      df.append(input);
+    }
+
+    dt_ = 0.0;
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      step(f, bcs, time_grid.at(i), dt, L);
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", time_grid.at(i+1));
+	input.add("S", spatial_grid.at(j));
+	input.add("f", static_cast<double>(f.at(j)));
+	df.append(input);
+      }
+    }
+    df.printToCsv(file_name,';');
+    return f;
+  }
+
+  /** \brief Performs single RKL2 step
+   *
+   * Increments \f$dt L Y\f$ are computed as \f$(I + dt L) Y - Y\f$ with the operator modified by boundary conditions,
+   * so the boundary rows behave as in explicit scheme. Stages are kept in internal buffers, the step does not allocate memory
+   * after the first one.
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicRKL2Scheme<Real>::step(std::vector<Real>& f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   double t,
+				   double dt,
+				   const BasicTridiagonalOperator<Real>& L) {
+    assemble(dt, L);
+    diff_operator_ = diff_base_;
+    for (auto bc : bcs) {
+      bc->beforeExplicitStep(diff_operator_);
+    }
+
+    unsigned int n = f.size();
+    initial_ = f;
+    initial_rate_.resize(n);
+    buffer_.resize(n);
+    diff_operator_.apply(initial_, initial_rate_);
+    for (unsigned int i = 0; i < n; i++) {
+      initial_rate_[i] -= initial_[i];
+    }
+
+    // first stage
+    previous_ = initial_;
+    for (unsigned int i = 0; i < n; i++) {
+      f[i] += mu_tilde_[1] * initial_rate_[i];
+    }
+    for (auto bc : bcs) {
+      bc->afterExplicitStep(f, t);
+    }
+
+    // f holds stage Y_{j-1}, previous_ holds Y_{j-2}
+    for (unsigned int j = 2; j <= stages_; j++) {
+      diff_operator_.apply(f, buffer_);
+      double rest = 1.0 - mu_[j] - nu_[j];
+      for (unsigned int i = 0; i < n; i++) {
+	buffer_[i] = mu_[j] * f[i] + nu_[j] * previous_[i] + rest * initial_[i]
+	  + mu_tilde_[j] * (buffer_[i] - f[i]) + gamma_tilde_[j] * initial_rate_[i];
+      }
+      previous_.swap(f);
+      f.swap(buffer_);
+      for (auto bc : bcs) {
+	bc->afterExplicitStep(f, t);
+      }
+    }
+  }
+
+  /** \brief Assembles operator \f$I + dt L\f$ and coefficients of the stages if time step has changed
+   *
+   * Spectral radius of \b L is bounded by the maximal sum of absolute values of elements in a row (Gershgorin theorem),
+   * number of stages is the smallest \f$s \ge 2\f$ satisfying \f$|dt| \rho(L) \le (s^2 + s - 2)/2\f$. Coefficients are:
+   * \f[ b_j = \frac{j^2 + j - 2}{2j(j+1)}, \; b_0 = b_1 = \frac{1}{3}, \quad w_1 = \frac{4}{s^2 + s - 2}, \quad
+   \tilde{\mu}_1 = b_1 w_1, \quad \mu_j = \frac{2j - 1}{j} \frac{b_j}{b_{j-1}}, \quad \nu_j = -\frac{j - 1}{j} \frac{b_j}{b_{j-2}},
+   \quad \tilde{\mu}_j = \mu_j w_1, \quad \tilde{\gamma}_j = -(1 - b_{j-1}) \tilde{\mu}_j \f]
+   *
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicRKL2Scheme<Real>::assemble(double dt, const BasicTridiagonalOperator<Real>& L) {
+    if (this->isSameTimeStep(dt, dt_)) {
+      return;
+    }
+    diff_base_ = BasicTridiagonalOperator<Real>::I(L.size()) + dt * L;
+    dt_ = dt;
+
+    int size = L.size();
+    double radius = 0.0;
+    for (int i = 0; i < size; i++) {
+      double row = std::fabs(static_cast<double>(L.mid(i)));
+      if (i > 0) {
+	row += std::fabs(static_cast<double>(L.low(i-1)));
+      }
+      if (i < size - 1) {
+	row += std::fabs(static_cast<double>(L.upp(i)));
+      }
+      radius = std::max(radius, row);
+    }
+    double z = SAFETY * std::fabs(dt) * radius;
+    stages_ = std::max(2u, static_cast<unsigned int>(std::ceil((std::sqrt(9.0 + 8.0 * z) - 1.0) / 2.0)));
+
+    unsigned int s = stages_;
+    std::vector<double> b(s + 1, 1.0 / 3.0);
+    for (unsigned int j = 2; j <= s; j++) {
+      b[j] = (j * j + j - 2.0) / (2.0 * j * (j + 1.0));
+    }
+    double w1 = 4.0 / (s * s + s - 2.0);
+    mu_.assign(s + 1, 0.0);
+    nu_.assign(s + 1, 0.0);
+    mu_tilde_.assign(s + 1, 0.0);
+    gamma_tilde_.assign(s + 1, 0.0);
+    mu_tilde_[1] = b[1] * w1;
+    for (unsigned int j = 2; j <= s; j++) {
+      mu_[j] = (2.0 * j - 1.0) / j * b[j] / b[j-1];
+      nu_[j] = -(j - 1.0) / j * b[j] / b[j-2];
+      mu_tilde_[j] = mu_[j] * w1;
+      gamma_tilde_[j] = -(1.0 - b[j-1]) * mu_tilde_[j];
+    }
+  }
+
+  // instantiations for supported types of elements
+  template class BasicRKL2Scheme<double>;
+  template class BasicRKL2Scheme<float>;
+  template class BasicRKL2Scheme<Dual>;
+}  // namespace marian
@@ -0,0 +1,88 @@
+#ifndef MARIAN_RKLSCHEME_HPP
+#define MARIAN_RKLSCHEME_HPP
+
+#include <FDM/schemes/fdScheme.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements second order Runge-Kutta-Legendre (RKL2) super-time-stepping scheme
+   *
+   * Explicit scheme is stable only for time steps \f$|dt| \rho(L) \le 2\f$, where \f$\rho(L)\f$ is spectral radius of the operator,
+   * which for diffusion is proportional to \f$D/h^2\f$. RKL2 scheme performs each time step with \f$s\f$ stages, each stage
+   * is single multiplication by the operator. Stages are combined with coefficients derived from shifted Legendre polynomials:
+   * \f[
+   \begin{aligned}
+   Y_1 &= Y_0 + \tilde{\mu}_1 dt L Y_0 \\
+   Y_j &= \mu_j Y_{j-1} + \nu_j Y_{j-2} + (1 - \mu_j - \nu_j) Y_0 + \tilde{\mu}_j dt L Y_{j-1} + \tilde{\gamma}_j dt L Y_0, \quad j = 2, \dots, s
+   \end{aligned}
+   \f]
+   * and \f$f_{n+1} = Y_s\f$. Stability region grows quadratically with number of stages:
+   * \f$|dt| \rho(L) \le (s^2 + s - 2)/2\f$, so the step of many explicit steps costs \f$O(\sqrt{|dt| \rho(L)})\f$ multiplications.
+   * Scheme is second order in time.
+   *
+   * Number of stages is chosen for each time step from the bound of spectral radius given by Gershgorin theorem.
+   * Boundary conditions modify the operator of the stages as in explicit scheme and set the boundary values after each stage.
+   * As explicit scheme, RKL2 requires only multiplications by tridiagonal operator, so it does not need a solver.
+   * For more information see \cite MortonMayers .
+   */
+  template<typename Real>
+  class BasicRKL2Scheme : public DCFDScheme<BasicRKL2Scheme<Real>, Real> {
+  public:
+    BasicRKL2Scheme(){};
+    /** \brief Provides a solver used in implicit scheme.
+     *
+     * For RKL2 scheme this method is empty.
+     */
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >&) override {
+    }
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override;
+    std::string info() const override {
+      return "RKL2";
+    }
+
+    /** \brief Returns number of stages of the last time step
+     */
+    unsigned int getStages() const {
+      return stages_;
+    }
+  private:
+    void step(std::vector<Real>& f,
+	      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+	      double t,
+	      double dt,
+	      const BasicTridiagonalOperator<Real>& L);
+    void assemble(double dt, const BasicTridiagonalOperator<Real>& L);
+
+    static constexpr double SAFETY = 1.1; /*!< \brief Factor increasing the bound of spectral radius*/
+
+    BasicTridiagonalOperator<Real> diff_base_;     /*!< \brief Operator \f$I + dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> diff_operator_; /*!< \brief Operator of the actual time step after applying boundary conditions*/
+    unsigned int stages_ = 0;                      /*!< \brief Number of stages for time step dt_*/
+    std::vector<double> mu_;                       /*!< \brief Coefficients \f$\mu_j\f$ of the stages*/
+    std::vector<double> nu_;                       /*!< \brief Coefficients \f$\nu_j\f$ of the stages*/
+    std::vector<double> mu_tilde_;                 /*!< \brief Coefficients \f$\tilde{\mu}_j\f$ of the stages*/
+    std::vector<double> gamma_tilde_;              /*!< \brief Coefficients \f$\tilde{\gamma}_j\f$ of the stages*/
+    std::vector<Real> initial_;                    /*!< \brief Solution at the beginning of the step \f$Y_0\f$*/
+    std::vector<Real> initial_rate_;               /*!< \brief Increment \f$dt L Y_0\f$*/
+    std::vector<Real> previous_;                   /*!< \brief Stage \f$Y_{j-2}\f$*/
+    std::vector<Real> buffer_;                     /*!< \brief Buffer for the next stage*/
+    double dt_ = 0.0;                              /*!< \brief Time step for which diff_base_ and coefficients were assembled*/
+  };
+
+  /** \ingroup schemes
+   * \brief RKL2 scheme working with doubles
+   */
+  typedef BasicRKL2Scheme<double> RKL2Scheme;
+
+} // namespace marian
+
+#endif /* MARIAN_RKLSCHEME_HPP */
@@ -0,0 +1,171 @@
+#include <FDM/schemes/spectralScheme.hpp>
+#include <cmath>
+#include <utils/fft.hpp>
+#include <utils/dataFrame.hpp>
+
+namespace marian {
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * Solution is propagated from the first to the last point of time grid in single step.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in (intermediate points are used only by fallback scheme)
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> SpectralScheme::solve(std::vector<double> f,
+					    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					    const std::vector<double>& time_grid,
+					    const TridiagonalOperator& L) {
+    if (!decompose(f, bcs, time_grid, L)) {
+      return fallback_->solve(f, bcs, time_grid, L);
+    }
+    return propagate(time_grid.back() - time_grid.front());
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Times of saved solutions
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  std::vector<double> SpectralScheme::solveAndSave(std::vector<double> f,
+						   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						   const std::vector<double>& spatial_grid,
+						   const std::vector<double>& time_grid,
+						   const TridiagonalOperator& L,
+						   const std::string file_name) {
+    auto snapshots = solveSnapshots(f, bcs, time_grid, L);
+    DataFrame df;
+    for (unsigned int i = 0; i < time_grid.size(); i++) {
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", time_grid.at(i));
+	input.add("S", spatial_grid.at(j));
+	input.add("f", snapshots[i][j]);
+	df.append(input);
+      }
+    }
+    df.printToCsv(file_name,';');
+    return snapshots.back();
+  }
+
+  /** \brief Solves PDE and returns solutions on all points of time grid
+   *
+   * Initial condition is transformed once, each snapshot costs single inverse transform.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Times of snapshots
+   * \param L Linear operator defining PDE
+   * \returns Solutions, one vector for each point of time grid (the first is the initial condition)
+   */
+  std::vector<std::vector<double> > SpectralScheme::solveSnapshots(std::vector<double> f,
+								   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+								   const std::vector<double>& time_grid,
+								   const TridiagonalOperator& L) {
+    std::vector<std::vector<double> > snapshots(1, f);
+    bool diagonalized = decompose(f, bcs, time_grid, L);
+    for (unsigned int i = 1; i < time_grid.size(); i++) {
+      if (diagonalized) {
+	snapshots.push_back(propagate(time_grid.at(i) - time_grid.front()));
+      } else {
+	std::vector<double> step_grid {time_grid.at(i-1), time_grid.at(i)};
+	snapshots.push_back(fallback_->solve(snapshots.back(), bcs, step_grid, L));
+      }
+    }
+    return snapshots;
+  }
+
+  /** \brief Checks structure of the problem and computes eigenvalues and coordinates of initial condition in the eigenbasis
+   *
+   * Boundary conditions are probed on copy of the operator at the first and the last point of time grid:
+   * they must set the boundary rows to identity and the boundary values to zero.
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns True if the problem is diagonalized by sine transform
+   */
+  bool SpectralScheme::decompose(const std::vector<double>& f,
+				 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				 const std::vector<double>& time_grid,
+				 const TridiagonalOperator& L) {
+    int size = L.size();
+    if (size < 4) {
+      return false;
+    }
+    for (double t : {time_grid.front(), time_grid.back()}) {
+      TridiagonalOperator probe(L);
+      std::vector<double> values(size, 0.0);
+      for (auto bc : bcs) {
+	bc->beforeImplicitStep(probe, values, t);
+      }
+      bool dirichlet = probe.mid(0) == 1.0 && probe.upp(0) == 0.0 && values[0] == 0.0
+	&& probe.mid(size-1) == 1.0 && probe.low(size-2) == 0.0 && values[size-1] == 0.0;
+      if (!dirichlet) {
+	return false;
+      }
+    }
+
+    unsigned int n = size - 2;
+    double l = L.low(0);
+    double d = L.mid(1);
+    double u = L.upp(1);
+    double scale = std::fabs(l) + std::fabs(d) + std::fabs(u);
+    for (int i = 1; i < size - 1; i++) {
+      if (std::fabs(L.low(i-1) - l) > TOLERANCE * scale || std::fabs(L.mid(i) - d) > TOLERANCE * scale
+	  || std::fabs(L.upp(i) - u) > TOLERANCE * scale) {
+	return false;
+      }
+    }
+    if (l * u <= 0.0) {
+      return false;
+    }
+    double log_ratio = 0.5 * std::log(l / u);
+    if (std::fabs(log_ratio) * (n + 1) > std::log(MAX_SCALING)) {
+      return false;
+    }
+
+    // scaling is centered, so its elements lie between MAX_SCALING^(-1/2) and MAX_SCALING^(1/2)
+    const double pi = std::acos(-1.0);
+    double coupling = (u > 0.0 ? 1.0 : -1.0) * std::sqrt(l * u);
+    scaling_.resize(n);
+    eigenvalues_.resize(n);
+    std::vector<double> scaled(n);
+    for (unsigned int j = 0; j < n; j++) {
+      scaling_[j] = std::exp(log_ratio * (j + 1.0 - 0.5 * (n + 1)));
+      eigenvalues_[j] = d + 2.0 * coupling * std::cos(pi * (j + 1.0) / (n + 1));
+      scaled[j] = f[j+1] / scaling_[j];
+    }
+    coefficients_ = sineTransform(scaled);
+    return true;
+  }
+
+  /** \brief Propagates decomposed initial condition by time \b tau
+   *
+   * \param tau Time elapsed from the first point of time grid
+   * \returns Solution in form of std::vector (with zero boundary values)
+   */
+  std::vector<double> SpectralScheme::propagate(double tau) const {
+    unsigned int n = coefficients_.size();
+    std::vector<double> modes(n);
+    for (unsigned int k = 0; k < n; k++) {
+      modes[k] = coefficients_[k] * std::exp(eigenvalues_[k] * tau);
+    }
+    auto interior = sineTransform(modes);
+    std::vector<double> ret(n + 2, 0.0);
+    for (unsigned int j = 0; j < n; j++) {
+      ret[j+1] = 2.0 / (n + 1) * scaling_[j] * interior[j];
+    }
+    return ret;
+  }
+
+}  // namespace marian
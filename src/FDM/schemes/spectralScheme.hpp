@@ -0,0 +1,73 @@
+#ifndef MARIAN_SPECTRALSCHEME_HPP
+#define MARIAN_SPECTRALSCHEME_HPP
+
+#include <FDM/schemes/fdScheme.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements exact time propagation of PDE with constant coefficients on uniform grid
+   *
+   * When coefficients of the process are constant and the grid is uniform, interior rows of operator \b L form tridiagonal Toeplitz matrix
+   * with subdiagonal \f$l\f$, diagonal \f$d\f$ and superdiagonal \f$u\f$. For homogeneous Dirichlet conditions
+   * (zero values on both ends) and \f$lu > 0\f$ the matrix is diagonalized by sine transform:
+   * \f[ L = D S \Lambda S^{-1} D^{-1}, \qquad D_{jj} = (l/u)^{j/2}, \qquad \lambda_k = d + 2\,\text{sgn}(u)\sqrt{lu}\cos\frac{k\pi}{n+1}, \f]
+   * where \f$S\f$ is matrix of discrete sine transform (see sineTransform). Solution of semi-discrete equation
+   * \f$\frac{df}{dt} = L f\f$ is propagated to any time exactly:
+   * \f[ f(t) = D S e^{(t - t_0)\Lambda} S^{-1} D^{-1} f(t_0), \f]
+   * for the cost of two transforms \f$O(N \log N)\f$, independently of number of time steps. Only the first and the last point of time grid
+   * are used by solve, solveAndSave and solveSnapshots return solutions on all points of time grid.
+   * Solution has no time discretization error, only the error of spatial discretization.
+   *
+   * If the problem does not have this structure (non-constant coefficients, non-uniform grid, non-homogeneous boundary conditions,
+   * or convection so strong that scaling \f$D\f$ exceeds MAX_SCALING) the problem is solved by fallback scheme.
+   */
+  class SpectralScheme : public DCFDScheme<SpectralScheme> {
+  public:
+    /** \brief Constructor
+     *
+     * \param fallback Scheme used for problems which are not diagonalized by sine transform
+     */
+    SpectralScheme(SmartPointer<FDScheme> fallback):
+      fallback_(fallback) {};
+
+    /** \brief Provides a solver used by fallback scheme
+     */
+    void setSolver(const SmartPointer<TridiagonalSolver>& solver) override {
+      fallback_->setSolver(solver);
+    }
+    std::vector<double> solve(std::vector<double> f,
+			      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			      const std::vector<double>& time_grid,
+			      const TridiagonalOperator& L) override;
+    std::vector<double> solveAndSave(std::vector<double> f,
+				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				     const std::vector<double>& spatial_grid,
+				     const std::vector<double>& time_grid,
+				     const TridiagonalOperator& L,
+				     const std::string file_name) override;
+    std::vector<std::vector<double> > solveSnapshots(std::vector<double> f,
+						     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						     const std::vector<double>& time_grid,
+						     const TridiagonalOperator& L);
+    std::string info() const override {
+      return "Spectral/" + fallback_->info();
+    }
+  private:
+    bool decompose(const std::vector<double>& f,
+		   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+		   const std::vector<double>& time_grid,
+		   const TridiagonalOperator& L);
+    std::vector<double> propagate(double tau) const;
+
+    static constexpr double MAX_SCALING = 1e8; /*!< \brief Maximal ratio of elements of diagonal scaling*/
+    static constexpr double TOLERANCE = 1e-8;  /*!< \brief Relative tolerance of check of constant coefficients*/
+
+    SmartPointer<FDScheme> fallback_;  /*!< \brief Scheme used for problems which are not diagonalized by sine transform*/
+    std::vector<double> scaling_;      /*!< \brief Diagonal scaling symmetrizing the interior operator*/
+    std::vector<double> eigenvalues_;  /*!< \brief Eigenvalues of the interior operator*/
+    std::vector<double> coefficients_; /*!< \brief Sine transform of scaled initial condition*/
+  };
+
+} // namespace marian
+
+#endif /* MARIAN_SPECTRALSCHEME_HPP */
@@ -0,0 +1,210 @@
+#include <FDM/schemes/trBDF2Scheme.hpp>
+#include <utils/dualNumber.hpp>
+#include <utils/dataFrame.hpp>
+#include <algorithm>
+
+namespace marian {
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param time_grid Time grid used in
+   * \param L Linear operator defining PDE
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicTRBDF2Scheme<Real>::solve(std::vector<Real> f,
+						   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						   const std::vector<double>& time_grid,
+						   const BasicTridiagonalOperator<Real>& L) {
+    dt_ = 0.0;
+    buffer_.resize(f.size());
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      step(f, bcs, time_grid.at(i), dt, L);
+    }
+    return f;
+  }
+
+  /** \brief Solves PDE defined by provided linear operator \b L and initial and boundary conditions. Additionally saves solution to CSV file
+   *
+   * \param f Initial condition
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid corresponding to initial conditions (used only to save the solution to CSV file)
+   * \param time_grid Time grid used for time dimension of FDM
+   * \param L Linear operator defining PDE
+   * \param file_name Name of CSV file
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicTRBDF2Scheme<Real>::solveAndSave(std::vector<Real> f,
+							  const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+							  const std::vector<double>& spatial_grid,
+							  const std::vector<double>& time_grid,
+							  const BasicTridiagonalOperator<Real>& L,
+							  const std::string file_name) {
+    DataFrame df;
+    for (unsigned int i = 0; i < f.size(); i++) {
+      DataEntryClerk input;
+      input.add("T", time_grid.front());
+      input.add("S", spatial_grid.at(i));
+      input.add("f", static_cast<double>(f.at(i)));
+      df.append(input);
+    }
+
+    dt_ = 0.0;
+    buffer_.resize(f.size());
+    for (unsigned int i = 0; i < time_grid.size()-1; i++) {
+      auto dt = time_grid.at(i+1) - time_grid.at(i);
+      step(f, bcs, time_grid.at(i), dt, L);
+      for (unsigned int j = 0; j < f.size(); j++) {
+	DataEntryClerk input;
+	input.add("T", time_grid.at(i+1));
+	input.add("S", spatial_grid.at(j));
+	input.add("f", static_cast<double>(f.at(j)));
+	df.append(input);
+      }
+    }
+    df.printToCsv(file_name,';');
+    return f;
+  }
+
+  /** \brief Performs single TR-BDF2 step and estimates its local error
+   *
+   * Local error of the step is \f$C dt^3 f'''\f$ with \f$C = \frac{-3\gamma^2 + 4\gamma - 2}{12(2-\gamma)}\f$. Third derivative
+   * is approximated by the divided difference of \f$L f\f$ at the beginning of the step, after the first stage and at the end of the step:
+   * \f[ e = 2 C dt L \left(\frac{f_n}{\gamma} - \frac{f^{*}}{\gamma(1-\gamma)} + \frac{f_{n+1}}{1-\gamma}\right) \f]
+   * The estimate is filtered by solving \f$(I - \frac{\gamma}{2} dt L) \tilde{e} = e\f$ with the factorization of the step,
+   * which removes overestimation of stiff (high-frequency) components damped by the scheme.
+   * Values on rows fixed by boundary conditions are set by the conditions, so the estimate is cleared on these rows.
+   * Stages evaluate boundary conditions at the times of their levels (see step), so changes of time dependent
+   * boundary values within the step enter the estimate through the rows next to the boundary.
+   *
+   * Operators are assembled and factorized only when the time step or the operator changes.
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   * \returns Estimate of local error in maximum norm
+   */
+  template<typename Real>
+  double BasicTRBDF2Scheme<Real>::stepWithError(std::vector<Real>& f,
+						const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+						double t,
+						double dt,
+						const BasicTridiagonalOperator<Real>& L) {
+    const double gamma = 2.0 - std::sqrt(2.0);
+    const double constant = (-3.0 * gamma * gamma + 4.0 * gamma - 2.0) / (12.0 * (2.0 - gamma));
+    buffer_.resize(f.size());
+    estimate_.assign(f.begin(), f.end());
+    step(f, bcs, t, dt, L);
+
+    for (unsigned int j = 0; j < f.size(); j++) {
+      estimate_[j] = estimate_[j] / gamma - buffer_[j] / (gamma * (1.0 - gamma)) + f[j] / (1.0 - gamma);
+    }
+    L.apply(estimate_, buffer_);
+    for (unsigned int j = 0; j < f.size(); j++) {
+      buffer_[j] *= 2.0 * constant * dt;
+    }
+    this->clearFixedRows(imp_base_, diff_imp_, buffer_);
+    solver_->solveFactorized(buffer_, buffer_);
+
+    double err = 0.0;
+    for (auto& e : buffer_) {
+      err = std::max(err, std::fabs(static_cast<double>(e)));
+    }
+    return err;
+  }
+
+  /** \brief Performs single TR-BDF2 step
+   *
+   * Trapezoidal stage writes \f$f^{*}\f$ to internal buffer, the right-hand side of BDF2 stage is combined in \b f
+   * and solved in place, so the step does not allocate memory. Both stages share the implicit operator and its factorization.
+   * Boundary conditions of each stage are evaluated at the time of the level the stage solves for: \f$t + \gamma dt\f$ in the trapezoidal
+   * stage and \f$t + dt\f$ in BDF2 stage (explicit part of the trapezoidal stage uses the known level at \b t).
+   * Time dependent boundary values are then of the same order as the scheme and their changes are seen by the error estimate
+   * (see stepWithError).
+   *
+   * \param f Solution, overwritten by solution on the next time level
+   * \param bcs Boundary conditions
+   * \param t Actual time
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicTRBDF2Scheme<Real>::step(std::vector<Real>& f,
+				     const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				     double t,
+				     double dt,
+				     const BasicTridiagonalOperator<Real>& L) {
+    const double gamma = 2.0 - std::sqrt(2.0);
+    const double star_weight = 1.0 / (gamma * (2.0 - gamma));
+    const double previous_weight = (1.0 - gamma) * (1.0 - gamma) / (gamma * (2.0 - gamma));
+    assemble(dt, L);
+
+    // trapezoidal stage
+    diff_exp_ = exp_base_;
+    for (auto bc : bcs) {
+      bc->beforeExplicitStep(diff_exp_);
+    }
+    diff_exp_.apply(f, buffer_);
+    for (auto bc : bcs) {
+      bc->afterExplicitStep(buffer_, t);
+    }
+    solveImplicit(buffer_, bcs, t + gamma * dt);
+
+    // BDF2 stage
+    for (unsigned int j = 0; j < f.size(); j++) {
+      f[j] = star_weight * buffer_[j] - previous_weight * f[j];
+    }
+    solveImplicit(f, bcs, t + dt);
+  }
+
+  /** \brief Solves system with implicit operator \f$I - \frac{\gamma}{2} dt L\f$ modified by boundary conditions in place
+   *
+   * \param f Right-hand side, overwritten by solution
+   * \param bcs Boundary conditions
+   * \param t Time passed to boundary conditions
+   */
+  template<typename Real>
+  void BasicTRBDF2Scheme<Real>::solveImplicit(std::vector<Real>& f,
+					      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+					      double t) {
+    diff_imp_ = imp_base_;
+    for (auto bc : bcs) {
+      bc->beforeImplicitStep(diff_imp_, f, t);
+    }
+    if (!solver_->isFactorized(diff_imp_)) {
+      solver_->factorize(diff_imp_);
+    }
+    solver_->solveFactorized(f, f);
+    for (auto bc : bcs) {
+      bc->afterImplicitStep(f, t);
+    }
+  }
+
+  /** \brief Assembles operators \f$I + \frac{\gamma}{2} dt L\f$ and \f$I - \frac{\gamma}{2} dt L\f$ if time step or operator has changed
+   *
+   * \param dt Time step
+   * \param L Linear operator defining PDE
+   */
+  template<typename Real>
+  void BasicTRBDF2Scheme<Real>::assemble(double dt, const BasicTridiagonalOperator<Real>& L) {
+    if (!this->isSameTimeStep(dt, dt_) || L != L_) {
+      const double gamma = 2.0 - std::sqrt(2.0);
+      auto I = BasicTridiagonalOperator<Real>::I(L.size());
+      exp_base_ = I + 0.5 * gamma * dt * L;
+      imp_base_ = I - 0.5 * gamma * dt * L;
+      L_ = L;
+      dt_ = dt;
+    }
+  }
+
+  // instantiations for supported types of elements
+  template class BasicTRBDF2Scheme<double>;
+  template class BasicTRBDF2Scheme<float>;
+  template class BasicTRBDF2Scheme<Dual>;
+}  // namespace marian
@@ -0,0 +1,87 @@
+#ifndef MARIAN_TRBDF2SCHEME_HPP
+#define MARIAN_TRBDF2SCHEME_HPP
+
+#include <FDM/schemes/fdScheme.hpp>
+#include <FDM/tridiagonalSolver.hpp>
+
+namespace marian {
+  /** \ingroup schemes
+   * \brief Class implements TR-BDF2 scheme
+   *
+   * Each time step consists of trapezoidal (Crank-Nicolson) stage of length \f$\gamma dt\f$ followed by second order
+   * backward differentiation (BDF2) stage using the solution at the beginning of the step and the solution after the first stage:
+   * \f[
+   \begin{aligned}
+   (I - \tfrac{\gamma}{2} dt L) f^{*} & = (I + \tfrac{\gamma}{2} dt L) f_n \\
+   (I - \tfrac{1-\gamma}{2-\gamma} dt L) f_{n+1} & = \tfrac{1}{\gamma(2-\gamma)} f^{*} - \tfrac{(1-\gamma)^2}{\gamma(2-\gamma)} f_n
+   \end{aligned}
+   \f]
+   * Scheme is second order and L-stable, so high-frequency components of the solution (e.g. coming from kinked payoffs)
+   * are damped also for large time steps, which Crank-Nicolson scheme does not guarantee.
+   * For \f$\gamma = 2 - \sqrt{2}\f$ both stages have the same implicit operator \f$I - \frac{\gamma}{2} dt L\f$,
+   * so the tridiagonal matrix is factorized once and the step costs about two Crank-Nicolson steps.
+   *
+   * Scheme provides embedded estimate of local error (see stepWithError), so it can be used with marian::AdaptiveScheme.
+   * For more information see \cite MortonMayers .
+   */
+  template<typename Real>
+  class BasicTRBDF2Scheme : public DCFDScheme<BasicTRBDF2Scheme<Real>, Real> {
+  public:
+    /** \brief Constructor
+     */
+    BasicTRBDF2Scheme(){};
+    /** \brief Provides a solver used in implicit stages
+     */
+    BasicTRBDF2Scheme(SmartPointer<BasicTridiagonalSolver<Real> > solver): solver_(solver) {};
+
+    void setSolver(const SmartPointer<BasicTridiagonalSolver<Real> >& solver) override {
+      solver_ = solver;
+    }
+    std::vector<Real> solve(std::vector<Real> f,
+			    const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			    const std::vector<double>& time_grid,
+			    const BasicTridiagonalOperator<Real>& L) override;
+    std::vector<Real> solveAndSave(std::vector<Real> f,
+				   const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+				   const std::vector<double>& spatial_grid,
+				   const std::vector<double>& time_grid,
+				   const BasicTridiagonalOperator<Real>& L,
+				   const std::string file_name) override;
+    double stepWithError(std::vector<Real>& f,
+			 const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+			 double t,
+			 double dt,
+			 const BasicTridiagonalOperator<Real>& L) override;
+    std::string info() const override {
+      return "TR-BDF2";
+    }
+  private:
+    void step(std::vector<Real>& f,
+	      const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+	      double t,
+	      double dt,
+	      const BasicTridiagonalOperator<Real>& L);
+    void solveImplicit(std::vector<Real>& f,
+		       const std::vector<SmartPointer<BoundaryCondition> >& bcs,
+		       double t);
+    void assemble(double dt, const BasicTridiagonalOperator<Real>& L);
+
+    SmartPointer<BasicTridiagonalSolver<Real> > solver_; /*!< \brief Solver used in implicit stages*/
+    BasicTridiagonalOperator<Real> exp_base_;            /*!< \brief Operator \f$I + \frac{\gamma}{2} dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> imp_base_;            /*!< \brief Operator \f$I - \frac{\gamma}{2} dt L\f$ assembled for time step dt_*/
+    BasicTridiagonalOperator<Real> diff_exp_;            /*!< \brief Explicit operator of the actual stage after applying boundary conditions*/
+    BasicTridiagonalOperator<Real> diff_imp_;            /*!< \brief Implicit operator of the actual stage after applying boundary conditions*/
+    BasicTridiagonalOperator<Real> L_;                   /*!< \brief Operator for which exp_base_ and imp_base_ were assembled*/
+    std::vector<Real> buffer_;                           /*!< \brief Buffer for solution after the first stage*/
+    std::vector<Real> estimate_;                         /*!< \brief Buffer for error estimate*/
+    double dt_ = 0.0;                                    /*!< \brief Time step for which exp_base_ and imp_base_ were assembled*/
+  };
+
+  /** \ingroup schemes
+   * \brief TR-BDF2 scheme working with doubles
+   */
+  typedef BasicTRBDF2Scheme<double> TRBDF2Scheme;
+
+} // namespace marian
+
+#endif /* MARIAN_TRBDF2SCHEME_HPP */
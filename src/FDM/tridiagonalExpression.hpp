@@ -0,0 +1,236 @@
+#ifndef MARIAN_TRIDIAGONALEXPRESSION_HPP
+#define MARIAN_TRIDIAGONALEXPRESSION_HPP
+
+namespace marian {
+
+  template<typename Real>
+  class BasicTridiagonalOperator;
+
+  /** \ingroup fdm
+   * \brief Base class of arithmetic expressions of tridiagonal operators
+   *
+   * Arithmetic operations on tridiagonal operators (addition, subtraction, multiplication and division by real number)
+   * do not create temporary operators. Instead they return lightweight objects (expression templates, see \cite joshi)
+   * representing the expression. The expression is evaluated element by element, in one pass,
+   * when it is assigned to marian::TridiagonalOperator. For example, in the code
+   \code{.cpp}
+   TridiagonalOperator A;
+   A = I + 0.5 * dt * L;
+   \endcode
+   * all elements of \b A are calculated in a single loop and, if \b A already has proper size, no memory is allocated.
+   *
+   * Class implements Curiously Recurring Template Pattern. Every expression provides type \b value_type of its elements, method size()
+   * and methods evalLow(i), evalMid(i), evalUpp(i) returning i-th element of lower, mid and upper diagonal.
+   *
+   * \note Expressions keep references to operators they were built from, so they should not outlive them.
+   * Expression should be assigned to marian::TridiagonalOperator rather than stored with \b auto.
+   */
+  template<typename E>
+  class TridiagonalExpression {
+  public:
+    /** \brief Returns the expression as derived type
+     */
+    const E& self() const {
+      return static_cast<const E&>(*this);
+    }
+  };
+
+  /** \ingroup fdm
+   * \brief Defines how expressions are stored in other expressions
+   *
+   * Operators are stored by reference, intermediate expressions are small and are stored by value.
+   */
+  template<typename E>
+  struct TridiagonalExpressionStorage {
+    typedef const E type; ///< Type used to store expression
+  };
+
+  /** \ingroup fdm
+   * \brief Tridiagonal operators are stored by reference
+   */
+  template<typename Real>
+  struct TridiagonalExpressionStorage<BasicTridiagonalOperator<Real> > {
+    typedef const BasicTridiagonalOperator<Real>& type; ///< Type used to store expression
+  };
+
+  /** \ingroup fdm
+   * \brief Expression representing sum of two tridiagonal operators
+   */
+  template<typename L, typename R>
+  class TridiagonalSum : public TridiagonalExpression<TridiagonalSum<L, R> > {
+  public:
+    typedef typename L::value_type value_type; ///< Type of elements
+    /** \brief Constructor
+     */
+    TridiagonalSum(const L& l, const R& r): l_(l), r_(r) {}
+    /** \brief Size of the operator
+     */
+    unsigned int size() const { return l_.size(); }
+    /** \brief i-th element of lower diagonal
+     */
+    value_type evalLow(unsigned int i) const { return l_.evalLow(i) + r_.evalLow(i); }
+    /** \brief i-th element of mid diagonal
+     */
+    value_type evalMid(unsigned int i) const { return l_.evalMid(i) + r_.evalMid(i); }
+    /** \brief i-th element of upper diagonal
+     */
+    value_type evalUpp(unsigned int i) const { return l_.evalUpp(i) + r_.evalUpp(i); }
+  private:
+    typename TridiagonalExpressionStorage<L>::type l_; /*!< \brief Left operand*/
+    typename TridiagonalExpressionStorage<R>::type r_; /*!< \brief Right operand*/
+  };
+
+  /** \ingroup fdm
+   * \brief Expression representing difference of two tridiagonal operators
+   */
+  template<typename L, typename R>
+  class TridiagonalDifference : public TridiagonalExpression<TridiagonalDifference<L, R> > {
+  public:
+    typedef typename L::value_type value_type; ///< Type of elements
+    /** \brief Constructor
+     */
+    TridiagonalDifference(const L& l, const R& r): l_(l), r_(r) {}
+    /** \brief Size of the operator
+     */
+    unsigned int size() const { return l_.size(); }
+    /** \brief i-th element of lower diagonal
+     */
+    value_type evalLow(unsigned int i) const { return l_.evalLow(i) - r_.evalLow(i); }
+    /** \brief i-th element of mid diagonal
+     */
+    value_type evalMid(unsigned int i) const { return l_.evalMid(i) - r_.evalMid(i); }
+    /** \brief i-th element of upper diagonal
+     */
+    value_type evalUpp(unsigned int i) const { return l_.evalUpp(i) - r_.evalUpp(i); }
+  private:
+    typename TridiagonalExpressionStorage<L>::type l_; /*!< \brief Left operand*/
+    typename TridiagonalExpressionStorage<R>::type r_; /*!< \brief Right operand*/
+  };
+
+  /** \ingroup fdm
+   * \brief Expression representing tridiagonal operator multiplied by real number
+   */
+  template<typename E>
+  class TridiagonalScaled : public TridiagonalExpression<TridiagonalScaled<E> > {
+  public:
+    typedef typename E::value_type value_type; ///< Type of elements
+    /** \brief Constructor
+     */
+    TridiagonalScaled(const E& e, value_type x): e_(e), x_(x) {}
+    /** \brief Size of the operator
+     */
+    unsigned int size() const { return e_.size(); }
+    /** \brief i-th element of lower diagonal
+     */
+    value_type evalLow(unsigned int i) const { return e_.evalLow(i) * x_; }
+    /** \brief i-th element of mid diagonal
+     */
+    value_type evalMid(unsigned int i) const { return e_.evalMid(i) * x_; }
+    /** \brief i-th element of upper diagonal
+     */
+    value_type evalUpp(unsigned int i) const { return e_.evalUpp(i) * x_; }
+  private:
+    typename TridiagonalExpressionStorage<E>::type e_; /*!< \brief Operand*/
+    value_type x_;                                     /*!< \brief Multiplier*/
+  };
+
+  /** \ingroup fdm
+   * \brief Expression representing tridiagonal operator divided by real number
+   */
+  template<typename E>
+  class TridiagonalDivided : public TridiagonalExpression<TridiagonalDivided<E> > {
+  public:
+    typedef typename E::value_type value_type; ///< Type of elements
+    /** \brief Constructor
+     */
+    TridiagonalDivided(const E& e, value_type x): e_(e), x_(x) {}
+    /** \brief Size of the operator
+     */
+    unsigned int size() const { return e_.size(); }
+    /** \brief i-th element of lower diagonal
+     */
+    value_type evalLow(unsigned int i) const { return e_.evalLow(i) / x_; }
+    /** \brief i-th element of mid diagonal
+     */
+    value_type evalMid(unsigned int i) const { return e_.evalMid(i) / x_; }
+    /** \brief i-th element of upper diagonal
+     */
+    value_type evalUpp(unsigned int i) const { return e_.evalUpp(i) / x_; }
+  private:
+    typename TridiagonalExpressionStorage<E>::type e_; /*!< \brief Operand*/
+    value_type x_;                                     /*!< \brief Divisor*/
+  };
+
+  /** \brief Overloading of + operator
+   *
+   * Operator defines addition of tridiagonal operators
+   *\f[
+   \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix} +
+   \begin{pmatrix}d_1 & e_1 \\f_1 & d_2 & e_2 \\& f_2 & \ddots & \ddots \\& & \ddots & \ddots & e_{n-1} \\& & & f_{n-1} & d_n\end{pmatrix} =
+   \begin{pmatrix}a_1 + d_1 & b_1 + e_1 \\ c_1 + f_1 & a_2 + d_2 & b_2 + e_2 \\& c_2 + f_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} + e_{n-1} \\& & & c_{n-1} + f_{n-1} & a_n + d_n\end{pmatrix}
+   \f]
+  */
+  template<typename L, typename R>
+  inline TridiagonalSum<L, R> operator+(const TridiagonalExpression<L>& l, const TridiagonalExpression<R>& r) {
+    return TridiagonalSum<L, R>(l.self(), r.self());
+  }
+
+  /** \brief Overloading of - operator
+   *
+   * Operator defines subtraction of tridiagonal operators
+   *\f[
+   \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix} -
+   \begin{pmatrix}d_1 & e_1 \\f_1 & d_2 & e_2 \\& f_2 & \ddots & \ddots \\& & \ddots & \ddots & e_{n-1} \\& & & f_{n-1} & d_n\end{pmatrix} =
+   \begin{pmatrix}a_1 - d_1 & b_1 - e_1 \\ c_1 - f_1 & a_2 - d_2 & b_2 - e_2 \\& c_2 - f_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} - e_{n-1} \\& & & c_{n-1} - f_{n-1} & a_n - d_n\end{pmatrix}
+   \f]
+  */
+  template<typename L, typename R>
+  inline TridiagonalDifference<L, R> operator-(const TridiagonalExpression<L>& l, const TridiagonalExpression<R>& r) {
+    return TridiagonalDifference<L, R>(l.self(), r.self());
+  }
+
+  /** \brief Overloading of * operator for TridiagonalOperator and a real number
+   *
+   * Operator defines left multiplication of tridiagonal operators and real number
+   *\f[
+   x \times
+   \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix} =
+   \begin{pmatrix}x \times a_1 & x \times b_1 \\x \times c_1 & x \times a_2 & x \times b_2
+   \\& x \times c_2 & \ddots & \ddots \\& & \ddots & \ddots & x \times b_{n-1} \\& & & x \times c_{n-1} & x \times a_n\end{pmatrix}
+   \f]
+  */
+  template<typename E>
+  inline TridiagonalScaled<E> operator*(typename E::value_type x, const TridiagonalExpression<E>& e) {
+    return TridiagonalScaled<E>(e.self(), x);
+  }
+
+  /** \brief Overloading of * operator for TridiagonalOperator and a real number
+   *
+   * Operator defines right multiplication of tridiagonal operators and real number
+   *\f[
+   \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix} \times x =
+   x \times \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix}
+   \f]
+  */
+  template<typename E>
+  inline TridiagonalScaled<E> operator*(const TridiagonalExpression<E>& e, typename E::value_type x) {
+    return TridiagonalScaled<E>(e.self(), x);
+  }
+
+  /** \brief Overloading of / operator for TridiagonalOperator and a real number
+   *
+   * Operator defines division of tridiagonal operators by real number
+   *\f[
+   \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix} \div x =
+   \begin{pmatrix}a_1 \div x &  b_1 \div x \\ c_1 \div x &  a_2 \div x &  b_2 \div x
+   \\&  c_2 \div x & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \div x \\& & &  c_{n-1} \div x &  a_n \div x\end{pmatrix}
+   \f]
+  */
+  template<typename E>
+  inline TridiagonalDivided<E> operator/(const TridiagonalExpression<E>& e, typename E::value_type x) {
+    return TridiagonalDivided<E>(e.self(), x);
+  }
+
+}  // namespace marian
+
+#endif /* MARIAN_TRIDIAGONALEXPRESSION_HPP */
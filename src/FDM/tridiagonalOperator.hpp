@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <iostream>
+#include <FDM/tridiagonalExpression.hpp>
 
 namespace marian {
 
@@ -29,39 +30,64 @@ namespace marian {
    * where first and last row should be properly handled by boundary conditions and \f$x_{i+1} = x_{i} + h\f$.
    *
    * TridiagonalOperator class encapsulates the logic of tridiagonal matrix and provides simple methods to handle this mathematical objects.
+   * Arithmetic operations on operators are implemented with expression templates (see marian::TridiagonalExpression).
+   *
+   * Class is templated on the type of elements (\b Real). marian::TridiagonalOperator is the operator of doubles,
+   * operator of floats halves the memory traffic of FDM algorithms where single precision is sufficient.
+   * Class is explicitly instantiated in tridiagonalOperator.cpp for all supported types.
    * More details see \cite london \cite capinski
    */
 
-  class TridiagonalOperator {   
+  template<typename Real>
+  class BasicTridiagonalOperator : public TridiagonalExpression<BasicTridiagonalOperator<Real> > {   
   public:
+    typedef Real value_type; ///< Type of elements
+
     /*! \name Constructors
      */
     /** \brief Default constructor*/
-    TridiagonalOperator(){};
-    explicit TridiagonalOperator(unsigned int size);
-    TridiagonalOperator(unsigned int size, double low, double mid, double upp);
+    BasicTridiagonalOperator(): size_(0) {};
+    explicit BasicTridiagonalOperator(unsigned int size);
+    BasicTridiagonalOperator(unsigned int size, Real low, Real mid, Real upp);
     
     /** \brief Constructor
 	\param low Lower diagonal
 	\param mid Mid diagonal
 	\param upp Upper diagonal
     */
-    TridiagonalOperator(const std::vector<double>& low, const std::vector<double>& mid, const std::vector<double>& upp):
+    BasicTridiagonalOperator(const std::vector<Real>& low, const std::vector<Real>& mid, const std::vector<Real>& upp):
       size_(mid.size()), low_(low), mid_(mid), upp_(upp) {};
+
+    /** \brief Constructor evaluating arithmetic expression of tridiagonal operators
+     */
+    template<typename E>
+    BasicTridiagonalOperator(const TridiagonalExpression<E>& e): size_(0) {
+      assign(e.self());
+    }
     //@}
 
+    /** \brief Evaluates arithmetic expression of tridiagonal operators
+     *
+     * Expression is evaluated in a single pass. If the operator has the size of expression no memory is allocated.
+     */
+    template<typename E>
+    BasicTridiagonalOperator& operator=(const TridiagonalExpression<E>& e) {
+      assign(e.self());
+      return *this;
+    }
+
     /*! \name Differential Operators
      */
     //@{
     
-    static TridiagonalOperator DPlus(int n, double h);
-    static TridiagonalOperator DMinus(int n, double h);  
-    static TridiagonalOperator DZero(int n, double h);
-    static TridiagonalOperator DZero(const std::vector<double>& grid);
-    static TridiagonalOperator DPlusMinus(int n, double h);
-    static TridiagonalOperator DPlusMinus(const std::vector<double>& grid);
-    static TridiagonalOperator I(int n);
-    static TridiagonalOperator I(const std::vector<double>& grid);
+    static BasicTridiagonalOperator DPlus(int n, double h);
+    static BasicTridiagonalOperator DMinus(int n, double h);  
+    static BasicTridiagonalOperator DZero(int n, double h);
+    static BasicTridiagonalOperator DZero(const std::vector<double>& grid);
+    static BasicTridiagonalOperator DPlusMinus(int n, double h);
+    static BasicTridiagonalOperator DPlusMinus(const std::vector<double>& grid);
+    static BasicTridiagonalOperator I(int n);
+    static BasicTridiagonalOperator I(const std::vector<double>& grid);
     //@}
     /*! \name Getters
      */
@@ -69,35 +95,129 @@ namespace marian {
     /** \brief Return size of tridiagonal matrix
      */
     int size() const { return size_; }
-    double low(int) const;
-    double mid(int) const;
-    double upp(int) const;
+    Real low(int) const;
+    Real mid(int) const;
+    Real upp(int) const;
+    //@}
+    /*! \name Elements access used by expression templates (no range checking)
+     */
+    //@{
+    /** \brief Returns i-th element of lower diagonal */
+    Real evalLow(unsigned int i) const { return low_[i]; }
+    /** \brief Returns i-th element of mid diagonal */
+    Real evalMid(unsigned int i) const { return mid_[i]; }
+    /** \brief Returns i-th element of upper diagonal */
+    Real evalUpp(unsigned int i) const { return upp_[i]; }
     //@}
     /*! \name Setters
      */
-    void setFirstRow(double, double);
-    void setMidRow(int, double, double, double);
-    void setMidRows(double, double, double);
-    void setLastRow(double, double);
+    void setFirstRow(Real, Real);
+    void setMidRow(int, Real, Real, Real);
+    void setMidRows(Real, Real, Real);
+    void setLastRow(Real, Real);
+
+    //@}
+    void apply(const std::vector<Real>& v, std::vector<Real>& result) const;
 
+    /*! \name Operations used by adjoint mode of schemes
+     */
+    //@{
+    BasicTridiagonalOperator transpose() const;
+    void addOuterProduct(Real alpha, const std::vector<Real>& x, const std::vector<Real>& y);
+    Real innerProduct(const BasicTridiagonalOperator& A) const;
     //@}
+
     
-    virtual ~TridiagonalOperator(){};
+    virtual ~BasicTridiagonalOperator(){};
     
-    friend std::ostream & operator<<(std::ostream &s, const TridiagonalOperator& A);
-    friend TridiagonalOperator operator+(const TridiagonalOperator&, const TridiagonalOperator&);
-    friend TridiagonalOperator operator-(const TridiagonalOperator&, const TridiagonalOperator&);
-    friend TridiagonalOperator operator*(double, const TridiagonalOperator&);
-    friend TridiagonalOperator operator*(const TridiagonalOperator&, double);
-    friend TridiagonalOperator operator/(const TridiagonalOperator&, double);
-    friend std::vector<double> operator*(const TridiagonalOperator&, std::vector<double>);
+    /** \brief Overloading of << operator
+     *
+     * Method allows to print the tridiagonal operator on console.
+     */
+    friend std::ostream& operator<<(std::ostream& s, const BasicTridiagonalOperator& A) {
+      s << ".\t" << A.mid_.front() << "\t" << A.upp_.front() << "\n";
+      for (unsigned int i = 1; i < A.size_-1; i++) {
+	s << A.low_.at(i-1) << "\t" << A.mid_.at(i) << "\t" << A.upp_.at(i) << "\n";
+      }
+      s << A.low_.back() << "\t" << A.mid_.back()  << "\t." << "\n";
+      return s;
+    }
+
+    /** \brief Overloading of * operator for TridiagonalOperator and a vector of real number
+     *
+     * \f[w = A \times v =
+     \begin{pmatrix}a_1 & b_1 \\c_1 & a_2 & b_2 \\& c_2 & \ddots & \ddots \\& & \ddots & \ddots & b_{n-1} \\& & & c_{n-1} & a_n\end{pmatrix} 
+     \times \begin{pmatrix} v_1 \\ v_2 \\ v_3  \\ \vdots \\ v_{n-1} \\ v_n\end{pmatrix} =
+     \begin{pmatrix} a_1 v_1 + v_2 b_1 \\ c_1 v_1 + a_2 v_2 + b_2 v_3 \\ \vdots  \\ \vdots \\ c_{n-2} v_{n-2} + a_{n-1} v_{n-1} + b_{n-1} v_{n} \\ c_{n-1} v_{n-1} + a_n v_n  \end{pmatrix} 
+     \f]
+     *
+     * \param A Tridiagonal matrix
+     * \param v Vector transformed by tridiagonal matrix A
+     * \return Vector w, after transformation  
+     */ 
+    friend std::vector<Real> operator*(const BasicTridiagonalOperator& A, const std::vector<Real>& v) {
+      std::vector<Real> result(A.size());
+      A.apply(v, result);
+      return result;
+    }
+
+    /** \brief Overloading of == operator
+     *
+     * Operators are equal if they have the same size and all elements of the three diagonals are equal.
+     * Comparison is exact, it is used to detect that the matrix of tridiagonal system has not changed
+     * and its factorization can be reused (see marian::BasicTridiagonalSolver::factorize).
+     */
+    friend bool operator==(const BasicTridiagonalOperator& to1, const BasicTridiagonalOperator& to2) {
+      return to1.mid_ == to2.mid_ && to1.low_ == to2.low_ && to1.upp_ == to2.upp_;
+    }
+
+    /** \brief Overloading of != operator
+     */
+    friend bool operator!=(const BasicTridiagonalOperator& to1, const BasicTridiagonalOperator& to2) {
+      return !(to1 == to2);
+    }
   private:
+    template<typename E>
+    void assign(const E& e);
+
     unsigned int size_;    /*!< \brief Size of matrix*/
-    std::vector<double> low_;  /*!< \brief Lower diagonal*/
-    std::vector<double> mid_;  /*!< \brief Mid diagonal*/
-    std::vector<double> upp_;  /*!< \brief upper diagonal*/ 
+    std::vector<Real> low_;  /*!< \brief Lower diagonal*/
+    std::vector<Real> mid_;  /*!< \brief Mid diagonal*/
+    std::vector<Real> upp_;  /*!< \brief upper diagonal*/ 
   };
 
+  /** \ingroup fdm
+   * \brief Tridiagonal operator of doubles
+   */
+  typedef BasicTridiagonalOperator<double> TridiagonalOperator;
+
+  /** \brief Evaluates expression element by element
+   *
+   * Diagonals are resized only if size of the expression differs from the size of operator. 
+   * Each element of the expression is read before the same element of the operator is written, 
+   * so the operator may appear in the expression assigned to it.
+   */
+  template<typename Real>
+  template<typename E>
+  void BasicTridiagonalOperator<Real>::assign(const E& e) {
+    unsigned int n = e.size();
+    size_ = n;
+    if (mid_.size() != n) {
+      low_.resize(n > 0 ? n-1 : 0);
+      mid_.resize(n);
+      upp_.resize(n > 0 ? n-1 : 0);
+    }
+    if (n == 0) {
+      return;
+    }
+    for (unsigned int i = 0; i < n-1; ++i) {
+      low_[i] = e.evalLow(i);
+      mid_[i] = e.evalMid(i);
+      upp_[i] = e.evalUpp(i);
+    }
+    mid_[n-1] = e.evalMid(n-1);
+  }
+
   /** \brief Creates tridiagonal operator representing forward differentiating of function f
    *
    * The differential operator \f$ D_{+} \f$ discretizes the first derivative with the forward differencing scheme
@@ -112,8 +232,9 @@ namespace marian {
    * \param n Size of matrix
    * \param h Increment used in differentiating scheme 
    */
-  inline TridiagonalOperator TridiagonalOperator::DPlus(int n, double h) {
-    TridiagonalOperator to(n);
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::DPlus(int n, double h) {
+    BasicTridiagonalOperator to(n);
     double inv = 1.0 / h;
     to.setFirstRow(1.0, 0.0);          
     to.setMidRows(0.0, -inv, inv);
@@ -136,8 +257,9 @@ namespace marian {
    * \param n Size of matrix
    * \param h Increment used in differentiating scheme 
    */
-  inline TridiagonalOperator TridiagonalOperator::DMinus(int n, double h) {
-    TridiagonalOperator to(n);
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::DMinus(int n, double h) {
+    BasicTridiagonalOperator to(n);
     double inv = 1.0 / h;
     to.setFirstRow(1.0, 0.0);          
     to.setMidRows(-inv, inv, 0.0);
@@ -158,8 +280,9 @@ namespace marian {
    * \param n Size of matrix
    * \param h Increment used in differentiating scheme 
    */
-  inline TridiagonalOperator TridiagonalOperator::DZero(int n, double h) {
-    TridiagonalOperator to(n);
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::DZero(int n, double h) {
+    BasicTridiagonalOperator to(n);
     double inv = 1.0 / (2.0*h);
     to.setFirstRow(1.0, 0.0);          
     to.setMidRows(-inv, 0.0, inv);
@@ -183,8 +306,9 @@ namespace marian {
    *
    * \param grid Grid used for discretization (may be non-uniform) 
    */
-  inline TridiagonalOperator TridiagonalOperator::DZero(const std::vector<double>& grid) {
-    TridiagonalOperator to(grid.size());
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::DZero(const std::vector<double>& grid) {
+    BasicTridiagonalOperator to(grid.size());
     to.setFirstRow(1.0, 0.0);          
     for (unsigned int i = 2; i < grid.size(); ++i) {
       double hm  = grid.at(i-1) - grid.at(i-2);
@@ -209,8 +333,9 @@ namespace marian {
    * \param n Size of matrix
    * \param h Increment used in differenting scheme 
    */
-  inline TridiagonalOperator TridiagonalOperator::DPlusMinus(int n, double h) {
-    TridiagonalOperator to(n);
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::DPlusMinus(int n, double h) {
+    BasicTridiagonalOperator to(n);
     double inv = 1.0 / (h*h);
     to.setFirstRow(1.0, 0.0);   
     to.setMidRows(inv, -2.0*inv, inv);
@@ -234,10 +359,11 @@ namespace marian {
    *
    * \param grid Grid used for discretization (may be non-uniform) 
    */
-  inline TridiagonalOperator TridiagonalOperator::DPlusMinus(const std::vector<double>& grid) {
-    TridiagonalOperator to(grid.size());
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::DPlusMinus(const std::vector<double>& grid) {
+    BasicTridiagonalOperator to(grid.size());
     to.setFirstRow(1.0, 0.0);          
-    for (unsigned int i = 2; i < grid.size()-1; ++i) {
+    for (unsigned int i = 2; i < grid.size(); ++i) {
       double hm  = grid.at(i-1) - grid.at(i-2);
       double hp  = grid.at(i)   - grid.at(i-1);
       double num = hm*hp*(hp+hm);
@@ -256,8 +382,9 @@ namespace marian {
    *
    * \param n Size of matrix
    */
-  inline TridiagonalOperator TridiagonalOperator::I(int n) {
-    TridiagonalOperator to(n);
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::I(int n) {
+    BasicTridiagonalOperator to(n);
     to.setFirstRow(1.0, 0.0);   
     to.setMidRows(0.0, 1.0, 0.0);
     to.setLastRow(0.0, 1.0);   
@@ -272,8 +399,9 @@ namespace marian {
    *
    * \param grid Grid used for discretization (may be non-uniform) 
    */
-  inline TridiagonalOperator TridiagonalOperator::I(const std::vector<double>& grid) {
-    TridiagonalOperator to(grid.size());
+  template<typename Real>
+  inline BasicTridiagonalOperator<Real> BasicTridiagonalOperator<Real>::I(const std::vector<double>& grid) {
+    BasicTridiagonalOperator to(grid.size());
     to.setFirstRow(1.0, 0.0);   
     to.setMidRows(0.0, 1.0, 0.0);
     to.setLastRow(0.0, 1.0);   
@@ -5,6 +5,21 @@
 
 namespace marian {
 
+  /** \ingroup fdm
+   * \brief Memory reused by tridiagonal solvers between calls
+   *
+   * Solvers resize the buffers on the first call, subsequent calls for systems of the same size do not allocate memory.
+   */
+  template<typename Real>
+  struct BasicSolverWorkspace {
+    std::vector<Real> temp; ///< Buffer for intermediate factors of elimination
+  };
+
+  /** \ingroup fdm
+   * \brief Workspace of solvers of systems of doubles
+   */
+  typedef BasicSolverWorkspace<double> SolverWorkspace;
+
   /** \ingroup fdm
    *
    * \brief Interface of tridiagonal system solvers
@@ -13,15 +28,17 @@ namespace marian {
    * \f[w = A \times v\f] 
    * 
    * where \f$w\f$ is real number vector, and \f$A\f$ is tridiagonal operator.
-   * This class is used to perform implicit step in FDM algorithm 
+   * This class is used to perform implicit step in FDM algorithm.
+   * Class is templated on the type of elements, marian::TridiagonalSolver is the interface of solvers of systems of doubles.
    *
    * \todo Implement Successive over-relaxation method \cite sor
    */
-  class TridiagonalSolver {
+  template<typename Real>
+  class BasicTridiagonalSolver {
   public:
     /** \brief Constructor
      */
-    TridiagonalSolver() {
+    BasicTridiagonalSolver() {
     }
 
     /** \brief Method solves tridiagonal system using algorithm implemented in derived classes
@@ -33,19 +50,90 @@ namespace marian {
      * \param w Vector of real numbers
      * \return Vector of real numbers being solution of system: \f$w = A \times v\f$ 
      */  
-    virtual std::vector<double> solve(const TridiagonalOperator& A,
-				      const std::vector<double>& w) const = 0;
+    virtual std::vector<Real> solve(const BasicTridiagonalOperator<Real>& A,
+				    const std::vector<Real>& w) const = 0;
+
+    /** \brief Method solves tridiagonal system writing the solution to provided vector
+     *
+     * Default implementation calls the allocating version, derived classes should override it 
+     * to solve the system without allocating memory.
+     *
+     * \param A Tridiagonal matrix defining tridiagonal system
+     * \param w Vector of real numbers
+     * \param v Vector of size equal to size of A, overwritten by solution of system: \f$w = A \times v\f$ 
+     * \param ws Workspace reused between calls
+     */  
+    virtual void solve(const BasicTridiagonalOperator<Real>& A,
+		       const std::vector<Real>& w,
+		       std::vector<Real>& v,
+		       BasicSolverWorkspace<Real>& ws) const {
+      (void)ws;
+      v = solve(A, w);
+    }
+
+    /** \brief Prepares solver for solving many systems with the same matrix
+     *
+     * In time stepping schemes the matrix of tridiagonal system is usually the same for all time steps of constant length.
+     * Method stores the matrix, so subsequent systems can be solved with solveFactorized. 
+     * Derived classes may precompute and store factors of the matrix, so only back-substitution is performed per time step.
+     *
+     * \param A Tridiagonal matrix defining tridiagonal system
+     */
+    virtual void factorize(const BasicTridiagonalOperator<Real>& A) {
+      factorized_ = A;
+    }
+
+    /** \brief Method solves tridiagonal system defined by matrix passed to factorize
+     *
+     * \param w Vector of real numbers
+     * \return Vector of real numbers being solution of system: \f$w = A \times v\f$ 
+     */
+    virtual std::vector<Real> solveFactorized(const std::vector<Real>& w) const {
+      return solve(factorized_, w);
+    }
+
+    /** \brief Method solves tridiagonal system defined by matrix passed to factorize writing the solution to provided vector
+     *
+     * \param w Vector of real numbers
+     * \param v Vector of size equal to size of factorized matrix, overwritten by solution of system: \f$w = A \times v\f$ 
+     */
+    virtual void solveFactorized(const std::vector<Real>& w, std::vector<Real>& v) const {
+      v = solveFactorized(w);
+    }
+
+    /** \brief Method solves tridiagonal systems with many right-hand sides and matrix passed to factorize
+     *
+     * \param columns Right-hand sides, overwritten by solutions
+     */
+    virtual void solveFactorized(std::vector<std::vector<Real> >& columns) const {
+      for (auto& column : columns) {
+	solveFactorized(column, column);
+      }
+    }
+
+    /** \brief Checks if given matrix is the one that was passed to factorize
+     */
+    bool isFactorized(const BasicTridiagonalOperator<Real>& A) const {
+      return factorized_ == A;
+    }
 
     /** \brief Virtual copy constructor
      */
-    virtual TridiagonalSolver* clone() const = 0;
+    virtual BasicTridiagonalSolver* clone() const = 0;
 
     /** \brief Destructor
      */
-    virtual ~TridiagonalSolver() {
+    virtual ~BasicTridiagonalSolver() {
     }
+  protected:
+    BasicTridiagonalOperator<Real> factorized_; /*!< \brief Matrix of the system passed to factorize*/
   };
 
+  /** \ingroup fdm
+   * \brief Interface of solvers of tridiagonal systems of doubles
+   */
+  typedef BasicTridiagonalSolver<double> TridiagonalSolver;
+
   /** \ingroup fdm 
    *
    * \brief Deeply copyable TridiagonalSolver
@@ -58,12 +146,12 @@ namespace marian {
    *
    * For more information about virtual copy constructor see \cite joshi
    */
-  template<typename T>
-  class DCTridiagonalSolver : public TridiagonalSolver {
+  template<typename T, typename Real = double>
+  class DCTridiagonalSolver : public BasicTridiagonalSolver<Real> {
   public:
     /** \brief Virtual copy constructor
      */
-    virtual TridiagonalSolver* clone() const {
+    virtual BasicTridiagonalSolver<Real>* clone() const {
       return new T(static_cast<const T&>(*this));
     }
   };
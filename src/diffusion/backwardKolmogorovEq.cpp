@@ -1,6 +1,9 @@
 #include <diffusion/backwardKolmogorovEq.hpp>
+#include <FDM/compactDiscretization.hpp>
+#include <utils/dualNumber.hpp>
 #include <algorithm>
 #include <cmath>
+#include <iostream>
 
 namespace marian {
 
@@ -13,15 +16,126 @@ namespace marian {
    * \param time_grid Time grid used to discretize the system
    * \returns Solution in form of std::vector
    */
-  std::vector<double> BackwardKolmogorowEquation::solve(SmartPointer<FDScheme> scheme,
-							std::vector<double> init,
-							std::vector<SmartPointer<BoundaryCondition> > bcs,
-							std::vector<double> spatial_grid,
-							std::vector<double> time_grid) {
-    auto L = getOperator(spatial_grid);
+  template<typename Real>
+  std::vector<Real> BasicBackwardKolmogorowEquation<Real>::solve(SmartPointer<BasicFDScheme<Real> > scheme,
+								 std::vector<Real> init,
+								 std::vector<SmartPointer<BoundaryCondition> > bcs,
+								 std::vector<double> spatial_grid,
+								 std::vector<double> time_grid) {
+    auto L = discretize(scheme, spatial_grid);
     std::reverse(time_grid.begin(), time_grid.end());
     return scheme->solve(init, bcs, time_grid, L);
   }
+  /** \brief Solves backward equation for many initial conditions
+   *
+   * Equation is solved for all initial conditions at once (for example payoffs of options with different strikes),
+   * the operator is discretized once and implicit schemes factorize it once for all problems (see FDScheme::solveMany).
+   *
+   * \param scheme Differential scheme
+   * \param inits Initial values, one vector for each problem
+   * \param bcs Boundary conditions, one set for each problem
+   * \param spatial_grid Spatial grid used to discretize the system
+   * \param time_grid Time grid used to discretize the system
+   * \returns Solutions, one vector for each problem
+   */
+  template<typename Real>
+  std::vector<std::vector<Real> > BasicBackwardKolmogorowEquation<Real>::solveMany(SmartPointer<BasicFDScheme<Real> > scheme,
+										   std::vector<std::vector<Real> > inits,
+										   std::vector<std::vector<SmartPointer<BoundaryCondition> > > bcs,
+										   std::vector<double> spatial_grid,
+										   std::vector<double> time_grid) {
+    auto L = discretize(scheme, spatial_grid);
+    std::reverse(time_grid.begin(), time_grid.end());
+    return scheme->solveMany(inits, bcs, time_grid, L);
+  }
+
+  /** \brief Solves backward equation and computes derivatives of functional of the solution with respect to parameters of process
+   *
+   * Scheme computes derivatives of functional \f$P = w \cdot f\f$ with respect to elements of the operator in adjoint mode
+   * (see FDScheme::solveAdjoint), which are converted to derivatives with respect to parameters of the process:
+   * \f[ \frac{\partial P}{\partial \sigma} = \Big\langle \frac{\partial P}{\partial L}, -\sigma D_{xx} \Big\rangle, \qquad
+   *     \frac{\partial P}{\partial \mu} = \Big\langle \frac{\partial P}{\partial L}, -D_{x} \Big\rangle, \qquad
+   *     \frac{\partial P}{\partial r} = \Big\langle \frac{\partial P}{\partial L}, I \Big\rangle \f]
+   *
+   * Derivatives are computed for the second order operator, compact discretization (see setCompactDiscretization) is not used in adjoint mode.
+   *
+   * \param scheme Differential scheme supporting adjoint mode (otherwise std::logic_error is thrown)
+   * \param init Initial value
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid used to discretize the system
+   * \param time_grid Time grid used to discretize the system
+   * \param w Weights defining functional of the solution
+   * \param sensitivity Overwritten by derivatives of functional with respect to diffusion, convection and decay
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicBackwardKolmogorowEquation<Real>::solveAdjoint(SmartPointer<BasicFDScheme<Real> > scheme,
+									std::vector<Real> init,
+									std::vector<SmartPointer<BoundaryCondition> > bcs,
+									std::vector<double> spatial_grid,
+									std::vector<double> time_grid,
+									const std::vector<Real>& w,
+									BasicConvectionDiffusion<Real>& sensitivity) {
+    if (compact_) {
+      std::cout << "Compact discretization is not supported in adjoint mode, second order operator is used" << std::endl;
+    }
+    auto L = getOperator(spatial_grid);
+    std::reverse(time_grid.begin(), time_grid.end());
+    BasicTridiagonalOperator<Real> dL;
+    auto solution = scheme->solveAdjoint(init, bcs, time_grid, L, w, dL);
+
+    auto d0 = BasicTridiagonalOperator<Real>::I(spatial_grid);
+    auto d1 = BasicTridiagonalOperator<Real>::DZero(spatial_grid);
+    auto d2 = BasicTridiagonalOperator<Real>::DPlusMinus(spatial_grid);
+    sensitivity.diffusion = -process_.diffusion * dL.innerProduct(d2);
+    sensitivity.convection = -dL.innerProduct(d1);
+    sensitivity.decay = dL.innerProduct(d0);
+    return solution;
+  }
+
+  /** \brief Solves stationary backward equation \f$\hat{L} f = g\f$ directly
+   *
+   * Solution does not change in time, so instead of time stepping until the solution stops changing
+   * the discretized system is solved once. Boundary conditions modify the rows of the operator and the elements of the right-hand side
+   * as in implicit step (see BoundaryCondition::beforeImplicitStep), e.g. Dirichlet condition sets the boundary value.
+   * Operator of the equation without decay and boundary conditions is singular (constants solve the homogeneous equation),
+   * so at least one boundary condition fixing the value is needed.
+   *
+   * With compact discretization the system \f$K f = M g\f$ is solved (see setCompactDiscretization).
+   *
+   * \param solver Tridiagonal solver
+   * \param source Right-hand side \f$g\f$ (zero vector for homogeneous equation)
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid used to discretize the system
+   * \param t Time passed to boundary conditions
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicBackwardKolmogorowEquation<Real>::solveSteadyState(SmartPointer<BasicTridiagonalSolver<Real> > solver,
+									    std::vector<Real> source,
+									    std::vector<SmartPointer<BoundaryCondition> > bcs,
+									    std::vector<double> spatial_grid,
+									    double t) {
+    BasicTridiagonalOperator<Real> L;
+    if (compact_) {
+      BasicTridiagonalOperator<Real> M;
+      getCompactOperators(spatial_grid, M, L);
+      std::vector<Real> rhs(source.size());
+      M.apply(source, rhs);
+      source.swap(rhs);
+    } else {
+      L = getOperator(spatial_grid);
+    }
+    for (auto& bc : bcs) {
+      bc->beforeImplicitStep(L, source, t);
+    }
+    auto f = solver->solve(L, source);
+    for (auto& bc : bcs) {
+      bc->afterImplicitStep(f, t);
+    }
+    return f;
+  }
+
   /** \brief Solves equation and save it to CSV file 
    *
    * \param scheme Differential scheme
@@ -32,13 +146,14 @@ namespace marian {
    * \param file_name CSV file name
    * \returns Solution in form of std::vector
    */ 
-  std::vector<double> BackwardKolmogorowEquation::solveAndSave(SmartPointer<FDScheme> scheme,
-							       std::vector<double> init,
-							       std::vector<SmartPointer<BoundaryCondition> > bcs,
-							       std::vector<double> spatial_grid,
-							       std::vector<double> time_grid,
-							       std::string file_name) {
-    auto L = getOperator(spatial_grid);
+  template<typename Real>
+  std::vector<Real> BasicBackwardKolmogorowEquation<Real>::solveAndSave(SmartPointer<BasicFDScheme<Real> > scheme,
+									std::vector<Real> init,
+									std::vector<SmartPointer<BoundaryCondition> > bcs,
+									std::vector<double> spatial_grid,
+									std::vector<double> time_grid,
+									std::string file_name) {
+    auto L = discretize(scheme, spatial_grid);
     std::reverse(time_grid.begin(), time_grid.end());
     return scheme->solveAndSave(init, bcs, spatial_grid, time_grid, L, file_name);
   }
@@ -49,12 +164,73 @@ namespace marian {
    * The operator is given as:
    * \f[\hat{L} = -\frac{1}{2}\sigma^2 \frac{\partial^2 }{\partial x^2} - \mu \frac{\partial }{\partial x}  \f]
    */
-  TridiagonalOperator BackwardKolmogorowEquation::getOperator(const std::vector<double>& sgrid) {
-    auto d0 = TridiagonalOperator::I(sgrid);
-    auto d1 = TridiagonalOperator::DZero(sgrid);
-    auto d2 = TridiagonalOperator::DPlusMinus(sgrid);
-    return -0.5*std::pow(process_.diffusion, 2)*d2
+  template<typename Real>
+  BasicTridiagonalOperator<Real> BasicBackwardKolmogorowEquation<Real>::getOperator(const std::vector<double>& sgrid) {
+    auto d0 = BasicTridiagonalOperator<Real>::I(sgrid);
+    auto d1 = BasicTridiagonalOperator<Real>::DZero(sgrid);
+    auto d2 = BasicTridiagonalOperator<Real>::DPlusMinus(sgrid);
+    return getOperator(d0, d1, d2);
+  }
+
+  /** \brief Constructs fourth order compact discretization \f$M f_t = K f\f$ of the operator of Backward Kolmogorow Equation
+   *
+   * Stiffness matrix \f$K\f$ approximates \f$M \hat{L}\f$ (see compactDiscretization), its boundary rows are the same
+   * as the boundary rows of the operator returned by getOperator.
+   *
+   * \param sgrid Spatial grid used to discretize the system
+   * \param M Overwritten by mass matrix
+   * \param K Overwritten by stiffness matrix
+   */
+  template<typename Real>
+  void BasicBackwardKolmogorowEquation<Real>::getCompactOperators(const std::vector<double>& sgrid,
+								  BasicTridiagonalOperator<Real>& M,
+								  BasicTridiagonalOperator<Real>& K) {
+    compactDiscretization<Real>(sgrid, -0.5*process_.diffusion*process_.diffusion, -process_.convection, process_.decay, M, K);
+  }
+
+  /** \brief Discretizes the operator for provided scheme
+   *
+   * If compact discretization is turned on, mass matrix is passed to the scheme and stiffness matrix is returned.
+   * Schemes not supporting mass matrix get the second order operator.
+   *
+   * \param scheme Differential scheme
+   * \param sgrid Spatial grid used to discretize the system
+   */
+  template<typename Real>
+  BasicTridiagonalOperator<Real> BasicBackwardKolmogorowEquation<Real>::discretize(SmartPointer<BasicFDScheme<Real> >& scheme,
+										   const std::vector<double>& sgrid) {
+    if (compact_) {
+      BasicTridiagonalOperator<Real> M;
+      BasicTridiagonalOperator<Real> K;
+      getCompactOperators(sgrid, M, K);
+      if (scheme->setMassMatrix(M)) {
+	return K;
+      }
+      std::cout << "Compact discretization is not supported by scheme " << scheme->info() << ", second order operator is used" << std::endl;
+    }
+    return getOperator(sgrid);
+  }
+
+  /** \brief Constructs the operator for Backward Kolmogorow Equation from discretized differential operators
+   *
+   * Differential operators depend only on the spatial grid, so they can be prepared once and combined
+   * with parameters of different processes (see marian::PricingPlan).
+   *
+   * \param d0 Identity operator
+   * \param d1 First derivative operator
+   * \param d2 Second derivative operator
+   */
+  template<typename Real>
+  BasicTridiagonalOperator<Real> BasicBackwardKolmogorowEquation<Real>::getOperator(const BasicTridiagonalOperator<Real>& d0,
+										    const BasicTridiagonalOperator<Real>& d1,
+										    const BasicTridiagonalOperator<Real>& d2) {
+    return -0.5*process_.diffusion*process_.diffusion*d2
       - process_.convection*d1
       + process_.decay * d0;
   }
+
+  // instantiations for supported types of elements
+  template class BasicBackwardKolmogorowEquation<double>;
+  template class BasicBackwardKolmogorowEquation<float>;
+  template class BasicBackwardKolmogorowEquation<Dual>;
 }  // namespace marian
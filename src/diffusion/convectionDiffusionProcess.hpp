@@ -9,12 +9,20 @@ namespace marian {
    * Diffusion convection PDE is given by formula:
    * \f[dX_t = c(t,X)dt+\sigma dW_t\f]
    * where D is diffusion term, c is convection term. Decay represent increase/decrease of diffusion process proportional to the value of diffusion.
+   *
+   * Structure is templated on the type of parameters (\b Real), parameters given as marian::Dual carry derivatives with respect to market inputs.
    */   
-  struct ConvectionDiffusion {
-    double diffusion; ///< Diffusion \b \a D
-    double convection; ///< Convection \b \a c
-    double decay;  ///< Convection \b \a d
+  template<typename Real>
+  struct BasicConvectionDiffusion {
+    Real diffusion; ///< Diffusion \b \a D
+    Real convection; ///< Convection \b \a c
+    Real decay;  ///< Convection \b \a d
   };
+
+  /** \ingroup diffusion
+   * \brief Parameters of diffusion-convection equation given in doubles
+   */
+  typedef BasicConvectionDiffusion<double> ConvectionDiffusion;
   
 }  // namespace marian
 
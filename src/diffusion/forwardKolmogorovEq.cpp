@@ -1,6 +1,9 @@
 #include <diffusion/forwardKolmogorovEq.hpp>
+#include <FDM/compactDiscretization.hpp>
+#include <utils/dualNumber.hpp>
 #include <algorithm>
 #include <cmath>
+#include <iostream>
 
 namespace marian {
 
@@ -13,15 +16,59 @@ namespace marian {
    * \param time_grid Time grid used to discretize the system
    * \returns Solution in form of std::vector
    */
-  std::vector<double> ForwardKolmogorowEquation::solve(SmartPointer<FDScheme> scheme,
-						       std::vector<double> init,
-						       std::vector<SmartPointer<BoundaryCondition> > bcs,
-						       std::vector<double> spatial_grid,
-						       std::vector<double> time_grid) {
-    auto L = getOperator(spatial_grid);
+  template<typename Real>
+  std::vector<Real> BasicForwardKolmogorowEquation<Real>::solve(SmartPointer<BasicFDScheme<Real> > scheme,
+								std::vector<Real> init,
+								std::vector<SmartPointer<BoundaryCondition> > bcs,
+								std::vector<double> spatial_grid,
+								std::vector<double> time_grid) {
+    auto L = discretize(scheme, spatial_grid);
     return scheme->solve(init, bcs, time_grid, L);
   }
 
+  /** \brief Solves stationary forward equation \f$\hat{L} f = g\f$ directly
+   *
+   * Solution does not change in time, so instead of time stepping until the solution stops changing
+   * the discretized system is solved once. Boundary conditions modify the rows of the operator and the elements of the right-hand side
+   * as in implicit step (see BoundaryCondition::beforeImplicitStep), e.g. Dirichlet condition sets the boundary value.
+   * Stationary density of process without decay is determined up to a constant, so at least one boundary condition fixing the value is needed
+   * (the density can be normalized afterwards).
+   *
+   * With compact discretization the system \f$K f = M g\f$ is solved (see setCompactDiscretization).
+   *
+   * \param solver Tridiagonal solver
+   * \param source Right-hand side \f$g\f$ (zero vector for homogeneous equation)
+   * \param bcs Boundary conditions
+   * \param spatial_grid Spatial grid used to discretize the system
+   * \param t Time passed to boundary conditions
+   * \returns Solution in form of std::vector
+   */
+  template<typename Real>
+  std::vector<Real> BasicForwardKolmogorowEquation<Real>::solveSteadyState(SmartPointer<BasicTridiagonalSolver<Real> > solver,
+									   std::vector<Real> source,
+									   std::vector<SmartPointer<BoundaryCondition> > bcs,
+									   std::vector<double> spatial_grid,
+									   double t) {
+    BasicTridiagonalOperator<Real> L;
+    if (compact_) {
+      BasicTridiagonalOperator<Real> M;
+      getCompactOperators(spatial_grid, M, L);
+      std::vector<Real> rhs(source.size());
+      M.apply(source, rhs);
+      source.swap(rhs);
+    } else {
+      L = getOperator(spatial_grid);
+    }
+    for (auto& bc : bcs) {
+      bc->beforeImplicitStep(L, source, t);
+    }
+    auto f = solver->solve(L, source);
+    for (auto& bc : bcs) {
+      bc->afterImplicitStep(f, t);
+    }
+    return f;
+  }
+
   /** \brief Solves equation and save it to CSV file 
    *
    * \param scheme Differential scheme
@@ -32,13 +79,14 @@ namespace marian {
    * \param file_name CSV file name
    * \returns Solution in form of std::vector
    */ 
-  std::vector<double> ForwardKolmogorowEquation::solveAndSave(SmartPointer<FDScheme> scheme,
-							      std::vector<double> init,
-							      std::vector<SmartPointer<BoundaryCondition> > bcs,
-							      std::vector<double> spatial_grid,
-							      std::vector<double> time_grid,
-							      std::string file_name) {
-    auto L = getOperator(spatial_grid);
+  template<typename Real>
+  std::vector<Real> BasicForwardKolmogorowEquation<Real>::solveAndSave(SmartPointer<BasicFDScheme<Real> > scheme,
+								       std::vector<Real> init,
+								       std::vector<SmartPointer<BoundaryCondition> > bcs,
+								       std::vector<double> spatial_grid,
+								       std::vector<double> time_grid,
+								       std::string file_name) {
+    auto L = discretize(scheme, spatial_grid);
     return scheme->solveAndSave(init, bcs, spatial_grid, time_grid, L, file_name);
   }
 
@@ -48,11 +96,71 @@ namespace marian {
    * The operator is given as:
    * \f[\hat{L} = \frac{1}{2}\sigma^2 \frac{\partial^2 }{\partial x^2} - \mu \frac{\partial }{\partial x}  \f]
    */
-  TridiagonalOperator ForwardKolmogorowEquation::getOperator(const std::vector<double>& spatial_grid) {
-    auto d0 = TridiagonalOperator::I(spatial_grid);
-    auto d1 = TridiagonalOperator::DZero(spatial_grid);
-    auto d2 = TridiagonalOperator::DPlusMinus(spatial_grid);
-    return 0.5*std::pow(process_.diffusion, 2)*d2 - process_.convection*d1 - process_.decay * d0;
+  template<typename Real>
+  BasicTridiagonalOperator<Real> BasicForwardKolmogorowEquation<Real>::getOperator(const std::vector<double>& spatial_grid) {
+    auto d0 = BasicTridiagonalOperator<Real>::I(spatial_grid);
+    auto d1 = BasicTridiagonalOperator<Real>::DZero(spatial_grid);
+    auto d2 = BasicTridiagonalOperator<Real>::DPlusMinus(spatial_grid);
+    return getOperator(d0, d1, d2);
+  }
+
+  /** \brief Constructs fourth order compact discretization \f$M f_t = K f\f$ of the operator of Forward Kolmogorow Equation
+   *
+   * Stiffness matrix \f$K\f$ approximates \f$M \hat{L}\f$ (see compactDiscretization), its boundary rows are the same
+   * as the boundary rows of the operator returned by getOperator.
+   *
+   * \param sgrid Spatial grid used to discretize the system
+   * \param M Overwritten by mass matrix
+   * \param K Overwritten by stiffness matrix
+   */
+  template<typename Real>
+  void BasicForwardKolmogorowEquation<Real>::getCompactOperators(const std::vector<double>& sgrid,
+								 BasicTridiagonalOperator<Real>& M,
+								 BasicTridiagonalOperator<Real>& K) {
+    compactDiscretization<Real>(sgrid, 0.5*process_.diffusion*process_.diffusion, -process_.convection, -process_.decay, M, K);
+  }
+
+  /** \brief Discretizes the operator for provided scheme
+   *
+   * If compact discretization is turned on, mass matrix is passed to the scheme and stiffness matrix is returned.
+   * Schemes not supporting mass matrix get the second order operator.
+   *
+   * \param scheme Differential scheme
+   * \param sgrid Spatial grid used to discretize the system
+   */
+  template<typename Real>
+  BasicTridiagonalOperator<Real> BasicForwardKolmogorowEquation<Real>::discretize(SmartPointer<BasicFDScheme<Real> >& scheme,
+										  const std::vector<double>& sgrid) {
+    if (compact_) {
+      BasicTridiagonalOperator<Real> M;
+      BasicTridiagonalOperator<Real> K;
+      getCompactOperators(sgrid, M, K);
+      if (scheme->setMassMatrix(M)) {
+	return K;
+      }
+      std::cout << "Compact discretization is not supported by scheme " << scheme->info() << ", second order operator is used" << std::endl;
+    }
+    return getOperator(sgrid);
   }
-  
+
+  /** \brief Constructs the operator for Forward Kolmogorow Equation from discretized differential operators
+   *
+   * Differential operators depend only on the spatial grid, so they can be prepared once and combined
+   * with parameters of different processes.
+   *
+   * \param d0 Identity operator
+   * \param d1 First derivative operator
+   * \param d2 Second derivative operator
+   */
+  template<typename Real>
+  BasicTridiagonalOperator<Real> BasicForwardKolmogorowEquation<Real>::getOperator(const BasicTridiagonalOperator<Real>& d0,
+										   const BasicTridiagonalOperator<Real>& d1,
+										   const BasicTridiagonalOperator<Real>& d2) {
+    return 0.5*process_.diffusion*process_.diffusion*d2 - process_.convection*d1 - process_.decay * d0;
+  }
+
+  // instantiations for supported types of elements
+  template class BasicForwardKolmogorowEquation<double>;
+  template class BasicForwardKolmogorowEquation<float>;
+  template class BasicForwardKolmogorowEquation<Dual>;
 } // namespace marian
@@ -21,31 +21,71 @@ namespace marian {
    * More information see \cite Huang \cite kineticsPhysics
    *
    * This class is used to construct the PDE basing on diffusion process and solve it using finite difference method.
+   * Class is templated on the type of elements of solution (\b Real), marian::ForwardKolmogorowEquation solves the equation in doubles.
+   *
+   * By default the operator is discretized with second order formulas (TridiagonalOperator::DZero, TridiagonalOperator::DPlusMinus).
+   * With compact discretization turned on (see setCompactDiscretization) fourth order compact discretization \f$M f_t = K f\f$
+   * is used (see compactDiscretization), which gives the same accuracy with several times fewer spatial nodes.
+   * Systems remain tridiagonal, but the scheme has to support mass matrix (see FDScheme::setMassMatrix).
    */   
-  class ForwardKolmogorowEquation {
+  template<typename Real>
+  class BasicForwardKolmogorowEquation {
   public:
     /** \brief constructor
+     *
+     * Parameters of the process are converted to the type of elements of solution.
+     * If parameters are given as marian::Dual, solution carries derivatives with respect to the market inputs.
+     *
+     * \param process Parameters of diffusion-convection process
+     */
+    template<typename P>
+    BasicForwardKolmogorowEquation(const BasicConvectionDiffusion<P>& process):
+      process_{Real(process.diffusion), Real(process.convection), Real(process.decay)} {}
+
+    /** \brief Turns on/off fourth order compact discretization of the operator
      */
-    ForwardKolmogorowEquation(ConvectionDiffusion process):
-      process_(process) {}
-
-    std::vector<double> solve(SmartPointer<FDScheme> scheme,
-			      std::vector<double> init,
-			      std::vector<SmartPointer<BoundaryCondition> > bcs,
-			      std::vector<double> spatial_grid,
-			      std::vector<double> time_grid);
+    void setCompactDiscretization(bool compact) {
+      compact_ = compact;
+    }
+
+    std::vector<Real> solve(SmartPointer<BasicFDScheme<Real> > scheme,
+			    std::vector<Real> init,
+			    std::vector<SmartPointer<BoundaryCondition> > bcs,
+			    std::vector<double> spatial_grid,
+			    std::vector<double> time_grid);
     
-    std::vector<double> solveAndSave(SmartPointer<FDScheme> scheme,
-				     std::vector<double> init,
-				     std::vector<SmartPointer<BoundaryCondition> > bcs,
-				     std::vector<double> spatial_grid,
-				     std::vector<double> time_grid,
-				     std::string file_name);
-
-    TridiagonalOperator getOperator(const std::vector<double>& sgrid);
+    std::vector<Real> solveAndSave(SmartPointer<BasicFDScheme<Real> > scheme,
+				   std::vector<Real> init,
+				   std::vector<SmartPointer<BoundaryCondition> > bcs,
+				   std::vector<double> spatial_grid,
+				   std::vector<double> time_grid,
+				   std::string file_name);
+
+    std::vector<Real> solveSteadyState(SmartPointer<BasicTridiagonalSolver<Real> > solver,
+				       std::vector<Real> source,
+				       std::vector<SmartPointer<BoundaryCondition> > bcs,
+				       std::vector<double> spatial_grid,
+				       double t = 0.0);
+
+    BasicTridiagonalOperator<Real> getOperator(const std::vector<double>& sgrid);
+    void getCompactOperators(const std::vector<double>& sgrid,
+			     BasicTridiagonalOperator<Real>& M,
+			     BasicTridiagonalOperator<Real>& K);
+    BasicTridiagonalOperator<Real> getOperator(const BasicTridiagonalOperator<Real>& d0,
+					       const BasicTridiagonalOperator<Real>& d1,
+					       const BasicTridiagonalOperator<Real>& d2);
   private:
-    ConvectionDiffusion process_; /*!< \brief Stochastic process  */ 
+    BasicTridiagonalOperator<Real> discretize(SmartPointer<BasicFDScheme<Real> >& scheme,
+					      const std::vector<double>& sgrid);
+
+    BasicConvectionDiffusion<Real> process_; /*!< \brief Stochastic process  */ 
+    bool compact_ = false;                   /*!< \brief True if compact discretization is used*/
   };
+
+  /** \ingroup diffusion
+   * \brief Forward Kolmogorow Equation solved in doubles
+   */
+  typedef BasicForwardKolmogorowEquation<double> ForwardKolmogorowEquation;
   
 }  // namespace marian
 
@@ -2,63 +2,319 @@
 #include <utils/mathUtils.hpp>
 #include <diffusion/backwardKolmogorovEq.hpp>
 #include <utils/utils.hpp>
+#include <utils/parallel.hpp>
 #include <cmath>
+#include <algorithm>
+#include <iostream>
 
 namespace marian {
 
   /** \brief  Method pricing option
    *
-   *  The steps of algorithm are as follows:
-   * - Obtaining concentration point and limits of the grid 
-   * - Creating the grid
-   * - Calculating initial condition
-   * - Obtaining boundary condition   
+   * Plan of pricing is prepared for the option (see prepare) and executed for the market.
+   *
+   * \param mkt Market data
+   * \param option Financial option
+   * \param Ns Number of spatial steps, default number 100
+   * \param Nt Number of time steps, default number 200
+   */
+  double FDMPricer::price(Market mkt, SmartPointer<Option> option, int Ns, int Nt) {
+    return price(prepare(mkt, option, Ns, Nt), mkt);
+  }
+
+  /** \brief  Method pricing option with prepared plan
+   *
+   *  Only market dependent steps are performed:
    * - Creating diffusion process
+   * - Combining differential operators of plan into operator of Backward Kolmogorov Equation
    * - Solving Backward Kolmogorov Equation
    * - Interpolating results
    *
+   * \param plan Plan prepared for priced option
+   * \param mkt Market data
+   */
+  double FDMPricer::price(const PricingPlan& plan, Market mkt) {
+    return interpolation(plan.spotGrid(), solvePricingPDE(plan, mkt, scheme_), mkt.spot);
+  }
+
+  /** \brief  Method pricing many options concurrently
+   *
+   * Each thread prices options with its own copy of the pricer, so schemes, solvers and their workspaces are not shared.
+   * Requests are distributed between threads with work stealing (see workStealingFor), so requests with different sizes
+   * of grids are balanced.
+   *
+   * \param requests Markets, options and sizes of grids
+   * \param threads Number of threads, by default number of hardware threads
+   * \return Prices in the order of requests
+   */
+  std::vector<double> FDMPricer::priceBatch(const std::vector<PricingRequest>& requests, unsigned int threads) const {
+    threads = std::max(1u, std::min<unsigned int>(threads, requests.size()));
+    std::vector<FDMPricer> pricers(threads, *this);
+    std::vector<double> prices(requests.size());
+    workStealingFor(requests.size(), threads, [&](unsigned int k, unsigned int i) {
+	const PricingRequest& request = requests[i];
+	prices[i] = pricers[k].price(request.market, request.option, request.Ns, request.Nt);
+      });
+    return prices;
+  }
+
+  /** \brief  Method pricing option and calculating greeks from the solution grid
+   *
+   * Plan of pricing is prepared for the option (see prepare) and greeks are calculated with the plan.
+   *
    * \param mkt Market data
    * \param option Financial option
    * \param Ns Number of spatial steps, default number 100
    * \param Nt Number of time steps, default number 200
+   * \pre Spot must lie between the second and the second to last node of spot grid.
    */
-  double FDMPricer::price(Market mkt, SmartPointer<Option> option, int Ns, int Nt) {
-    auto factory = option->allocateFactory();
-    // Generating grid's range and concentration points
-    auto low = factory->lowerSpotLmt();
-    auto upp = factory->upperSpotLmt();
-    auto concentration_point = factory->getConcentrationPoint();
-	
-	// Converting infinite range to finite 
-    if (low == 0.0) {
-      low = range_setter_->getLowerBound(mkt, option);
+  PricingResult FDMPricer::priceWithGreeks(Market mkt, SmartPointer<Option> option, int Ns, int Nt) {
+    return priceWithGreeks(prepare(mkt, option, Ns, Nt), mkt);
+  }
+
+  /** \brief  Method pricing option with prepared plan and calculating greeks from the solution grid
+   *
+   * Pricing PDE is solved as in price, the scheme provides also the solution on the next to last time level
+   * (see FDScheme::solveWithPrevious), so the solution on the last two time levels \f$V(t_1)\f$ and \f$V(t_0)\f$ is available
+   * after single solve and the price is the same as the price returned by price. Greeks are obtained by post-processing:
+   * - delta and gamma are calculated on every node of spot grid by three point finite difference formulas
+   *   for non-uniform grid (see TridiagonalOperator::DZero and TridiagonalOperator::DPlusMinus) and interpolated at spot,
+   * - theta is calculated as \f$(V(t_1) - V(t_0)) / (t_1 - t_0)\f$ interpolated at spot.
+   *
+   * \param plan Plan prepared for priced option
+   * \param mkt Market data
+   * \pre Spot must lie between the second and the second to last node of spot grid.
+   */
+  PricingResult FDMPricer::priceWithGreeks(const PricingPlan& plan, Market mkt) {
+    auto& grid = plan.spotGrid();
+    auto& tgrid = plan.timeGrid();
+
+    // Generating stochastic process from market data
+    ConvectionDiffusion diffusion = mkt2process(mkt);
+
+    // Solving PDE and keeping the solution on the next to last time level
+    BackwardKolmogorowEquation bpde(diffusion);
+    auto L = bpde.getOperator(plan.identity(), plan.firstDerivative(), plan.secondDerivative());
+    std::vector<double> previous;
+    auto fdm_solution = scheme_->solveWithPrevious(plan.initialCondition(), plan.boundaryConditions(), plan.backwardTimeGrid(), L, previous);
+
+    // Post-processing of the solution
+    auto gamma = TridiagonalOperator::DPlusMinus(grid) * fdm_solution;
+    double dt = tgrid.at(1) - tgrid.at(0);
+    PricingResult result;
+    result.price = interpolation(grid, fdm_solution, mkt.spot);
+    result.delta = deltaAtSpot(grid, fdm_solution, mkt.spot);
+    result.gamma = interpolation(grid, gamma, mkt.spot);
+    result.theta = (interpolation(grid, previous, mkt.spot) - result.price) / dt;
+    return result;
+  }
+
+  /** \brief  Method pricing option and calculating greeks with Richardson extrapolation from nested grids
+   *
+   * Price and greeks are calculated by priceWithGreeks on \b levels grids, each level doubles the number of spatial
+   * and time intervals of the previous one (\f$N_s^{(k)} = 2^k (N_s - 1) + 1\f$, the same for \f$N_t\f$), so the grids are nested
+   * for uniform grid builders. Levels are solved concurrently with copies of the pricer (see priceBatch).
+   * Results are combined by Richardson extrapolation (see richardsonExtrapolation): price, delta and gamma are assumed
+   * to converge with second order (second order scheme, e.g. Crank-Nicolson with Rannacher start-up), theta obtained from
+   * the last time step converges with first order. Errors are estimated by the difference between the two highest orders of extrapolation.
+   *
+   * Extrapolation requires smooth convergence, so spot has to lie on a common node of the grids (error of interpolation
+   * between the nodes changes irregularly with the grid). The node of the coarsest grid nearest to spot is moved to spot
+   * by mapping the range of the grids (see prepare). If the range is set by range setup on both sides, also the kink of the payoff
+   * (concentration point of the option) is moved to the node, which is chosen between spot and the kink, so the range only grows.
+   * If the range can not be mapped (both bounds are given by the option), extrapolation is not performed:
+   * the result of the finest grid is returned with the difference from the previous grid as error estimate.
+   * Estimates cover the discretization error, error of truncating the domain to the range of the grid is not included.
+   *
+   * \param mkt Market data
+   * \param option Financial option
+   * \param Ns Number of spatial steps on the coarsest grid, default number 100
+   * \param Nt Number of time steps on the coarsest grid, default number 200
+   * \param levels Number of grids, default number 2
+   * \param threads Number of threads, by default number of hardware threads
+   */
+  ExtrapolatedResult FDMPricer::priceExtrapolated(Market mkt, SmartPointer<Option> option, int Ns, int Nt, unsigned int levels,
+						  unsigned int threads) const {
+    levels = std::max(1u, levels);
+    threads = std::max(1u, std::min(threads, levels));
+
+    // node of the coarsest grid nearest to spot is placed at spot on all levels
+    auto coarse = prepare(mkt, option, Ns, Nt).spatialGrid();
+    double x = std::log(mkt.spot);
+    int node = std::lower_bound(coarse.begin(), coarse.end(), x) - coarse.begin();
+    if (node > 0 && x - coarse.at(node - 1) < coarse.at(std::min(node, Ns - 1)) - x) {
+      node--;
     }
-    if (upp == INFTY) {
-      upp = range_setter_->getUpperBound(mkt, option);
+    node = std::max(1, std::min(node, Ns - 2));
+    // kink is placed on the node rounded toward spot, kink closer to spot than one cell stays between the nodes
+    double xk = std::log(option->allocateFactory()->getConcentrationPoint());
+    int kink = -1;
+    if (xk > coarse.front() && xk < coarse.back()) {
+      int upper = std::lower_bound(coarse.begin(), coarse.end(), xk) - coarse.begin();
+      double position = upper - (coarse.at(upper) - xk) / (coarse.at(upper) - coarse.at(upper - 1));
+      kink = node + static_cast<int>(position - node);
     }
-  
-    // Generating grid
-    auto sgrid = sgrid_->buildGrid(std::log(low), std::log(upp), Ns, concentration_point);
-    auto tgrid = tgrid_->buildGrid(0.0, option->getT(), Nt, 0.0);
-    
-    // Initial condition
-    std::vector<double> grid;
-    for (auto i : sgrid) {
-      grid.push_back(std::exp(i));
+
+    std::vector<PricingPlan> plans;
+    bool on_node = true;
+    for (unsigned int level = 0; level < levels; ++level) {
+      int level_node = node << level;
+      plans.push_back(prepare(mkt, option, ((Ns - 1) << level) + 1, ((Nt - 1) << level) + 1, level_node, kink < 0 ? -1 : kink << level));
+      auto& sgrid = plans.back().spatialGrid();
+      on_node = on_node && std::fabs(sgrid.at(level_node) - x) <= 1e-12 * (sgrid.back() - sgrid.front());
     }
-    auto initial = factory->initialCondition(grid);
- 
-    // Boundary conditions
-    auto boundary_condition = factory->getBoundarySpotConditions(mkt, low, upp);
+
+    std::vector<FDMPricer> pricers(threads, *this);
+    std::vector<PricingResult> results(levels);
+    // the finest level is the most expensive, so it is started first
+    workStealingFor(levels, threads, [&](unsigned int k, unsigned int i) {
+	unsigned int level = levels - 1 - i;
+	results[level] = pricers[k].priceWithGreeks(plans[level], mkt);
+      });
+
+    std::vector<double> price, delta, gamma, theta;
+    for (auto& result : results) {
+      price.push_back(result.price);
+      delta.push_back(result.delta);
+      gamma.push_back(result.gamma);
+      theta.push_back(result.theta);
+    }
+    ExtrapolatedResult extrapolated;
+    if (!on_node) {
+      std::cout << "Spot can not be placed on the node of the grids, extrapolation is not performed" << std::endl;
+      unsigned int last = levels - 1;
+      unsigned int previous = levels > 1 ? levels - 2 : last;
+      extrapolated.value = results[last];
+      extrapolated.error.price = std::fabs(price[last] - price[previous]);
+      extrapolated.error.delta = std::fabs(delta[last] - delta[previous]);
+      extrapolated.error.gamma = std::fabs(gamma[last] - gamma[previous]);
+      extrapolated.error.theta = std::fabs(theta[last] - theta[previous]);
+      return extrapolated;
+    }
+    extrapolated.value.price = richardsonExtrapolation(price, 2.0, extrapolated.error.price);
+    extrapolated.value.delta = richardsonExtrapolation(delta, 2.0, extrapolated.error.delta);
+    extrapolated.value.gamma = richardsonExtrapolation(gamma, 2.0, extrapolated.error.gamma);
+    extrapolated.value.theta = richardsonExtrapolation(theta, 1.0, extrapolated.error.theta);
+    return extrapolated;
+  }
+
+  /** \brief  Method pricing option and calculating derivatives of the price with respect to market inputs
+   *
+   * Pricing PDE is solved once in marian::Dual numbers (see price for the steps of algorithm).
+   * Volatility and risk free rate are seeded with unit tangents, so the tangents of the result are:
+   * - tangent(0) - delta, calculated from the solution as in priceWithGreeks (see deltaAtSpot)
+   * - tangent(1) - vega, derivative with respect to volatility
+   * - tangent(2) - rho, derivative with respect to risk free rate
+   *
+   * Solution on fixed grid does not depend on spot, so the derivative of linear interpolation at spot would give
+   * delta of first order only, the three point formula is second order.
+   * Grid and boundary conditions are treated as independent of market inputs, so vega and rho are
+   * derivatives of the discrete solution on fixed grid (bumping the market in price moves the range of grid).
+   *
+   * \param mkt Market data
+   * \param option Financial option
+   * \param Ns Number of spatial steps, default number 100
+   * \param Nt Number of time steps, default number 200
+   */
+  Dual FDMPricer::priceWithSensitivities(Market mkt, SmartPointer<Option> option, int Ns, int Nt) {
+    auto plan = prepare(mkt, option, Ns, Nt);
+    auto fdm_solution = solvePricingPDE(plan, seedMarket(mkt), dual_scheme_);
+    auto price = interpolation(plan.spotGrid(), fdm_solution, Dual(mkt.spot));
+    std::vector<double> values;
+    values.reserve(fdm_solution.size());
+    for (auto& value : fdm_solution) {
+      values.push_back(value.value());
+    }
+    std::array<double, 3> gradient {{deltaAtSpot(plan.spotGrid(), values, mkt.spot), price.tangent(1), price.tangent(2)}};
+    return Dual(price.value(), gradient);
+  }
+
+  /** \brief  Method solving pricing PDE with prepared plan in given type of elements
+   *
+   * \param plan Plan prepared for priced option
+   * \param mkt Market data
+   * \param scheme Scheme working with elements of type \b Real
+   * \returns Solution on the spot grid of the plan
+   */
+  template<typename Real>
+  std::vector<Real> FDMPricer::solvePricingPDE(const PricingPlan& plan,
+					       BasicMarket<Real> mkt,
+					       SmartPointer<BasicFDScheme<Real> > scheme) {
+    std::vector<Real> initial(plan.initialCondition().begin(), plan.initialCondition().end());
 
     // Generating stochastic process from market data
-    ConvectionDiffusion diffusion = mkt2process(mkt);
+    BasicConvectionDiffusion<Real> diffusion = mkt2process(mkt);
 
     // Formulating PDE problem
+    BasicBackwardKolmogorowEquation<Real> bpde(diffusion);
+    auto L = bpde.getOperator(plan.identity(), plan.firstDerivative(), plan.secondDerivative());
+    return scheme->solve(initial, plan.boundaryConditions(), plan.backwardTimeGrid(), L);
+  }
+
+  /** \brief  Method calculating delta from the solution
+   *
+   * Delta is calculated on every node of spot grid by three point finite difference formula for non-uniform grid
+   * (see TridiagonalOperator::DZero) and interpolated at spot. All methods calculating greeks use this delta.
+   *
+   * \param grid Spot grid
+   * \param solution Solution on the spot grid
+   * \param spot Spot
+   * \pre Spot must lie between the second and the second to last node of spot grid.
+   */
+  double FDMPricer::deltaAtSpot(const std::vector<double>& grid, const std::vector<double>& solution, double spot) {
+    return interpolation(grid, TridiagonalOperator::DZero(grid) * solution, spot);
+  }
+
+  /** \brief  Method pricing option and calculating derivatives of the price with respect to market inputs in adjoint mode
+   *
+   * Price is the functional \f$P = w \cdot V\f$ of the solution, where \f$w\f$ are weights of linear interpolation at spot.
+   * Scheme solves the pricing PDE and propagates the weights backward in time with transposed operators (see FDScheme::solveAdjoint),
+   * which gives derivatives of the price with respect to parameters of the process for the cost of about two solves.
+   * Derivatives with respect to market inputs are obtained by chain rule through mkt2process. The result has the same form
+   * as the result of priceWithSensitivities:
+   * - tangent(0) - delta, calculated from the solution as in priceWithGreeks (see deltaAtSpot)
+   * - tangent(1) - vega, derivative with respect to volatility
+   * - tangent(2) - rho, derivative with respect to risk free rate
+   *
+   * Cost does not grow with number of parameters of the operator, so adjoint mode pays off when many sensitivities are needed.
+   * Scheme of the pricer must support adjoint mode (implicit and Crank-Nicolson schemes do, marian::AutoScheme chooses one of them),
+   * otherwise std::logic_error is thrown (see FDScheme::solveAdjoint).
+   * Grid and boundary conditions are treated as independent of market inputs.
+   *
+   * \param mkt Market data
+   * \param option Financial option
+   * \param Ns Number of spatial steps, default number 100
+   * \param Nt Number of time steps, default number 200
+   */
+  Dual FDMPricer::priceAdjoint(Market mkt, SmartPointer<Option> option, int Ns, int Nt) {
+    auto plan = prepare(mkt, option, Ns, Nt);
+    auto& grid = plan.spotGrid();
+
+    // Weights of linear interpolation at spot
+    unsigned int position = std::lower_bound(grid.begin(), grid.end(), mkt.spot) - grid.begin();
+    double h = grid.at(position) - grid.at(position-1);
+    std::vector<double> w(grid.size(), 0.0);
+    w.at(position-1) = (grid.at(position) - mkt.spot) / h;
+    w.at(position) = (mkt.spot - grid.at(position-1)) / h;
+
+    // Solving PDE in adjoint mode
+    ConvectionDiffusion diffusion = mkt2process(mkt);
     BackwardKolmogorowEquation bpde(diffusion);
-    auto fdm_solution  = bpde.solve(scheme_, initial,  boundary_condition, sgrid, tgrid);
-    return interpolation(grid, fdm_solution , mkt.spot);
+    ConvectionDiffusion sensitivity;
+    auto fdm_solution = bpde.solveAdjoint(scheme_, plan.initialCondition(), plan.boundaryConditions(), plan.spatialGrid(), plan.timeGrid(), w, sensitivity);
+
+    // Chain rule through parameters of the process
+    auto tangents = mkt2process(seedMarket(mkt));
+    std::array<double, 3> gradient;
+    for (unsigned int k = 0; k < gradient.size(); ++k) {
+      gradient[k] = sensitivity.diffusion * tangents.diffusion.tangent(k)
+	+ sensitivity.convection * tangents.convection.tangent(k)
+	+ sensitivity.decay * tangents.decay.tangent(k);
+    }
+    gradient[0] += deltaAtSpot(grid, fdm_solution, mkt.spot);
+    return Dual(interpolation(grid, fdm_solution, mkt.spot), gradient);
   }
+
    /** \brief  Method solves pricing PDE and save results to csv
    *
    *  The steps of algorithm are as follows:
@@ -77,22 +333,98 @@ namespace marian {
    * \param Nt Number of time steps
    */
   void FDMPricer::solveAndSave(Market mkt, SmartPointer<Option> option, std::string file, int Ns, int Nt) {
+    auto plan = prepare(mkt, option, Ns, Nt);
+
+	// Generating stochastic process from market data
+    ConvectionDiffusion diffusion = mkt2process(mkt);
+
+	// Formulating PDE problem
+    BackwardKolmogorowEquation bpde(diffusion);
+    bpde.solveAndSave(scheme_, plan.initialCondition(),  plan.boundaryConditions(), plan.spatialGrid(), plan.timeGrid(), file);
+  }
+
+  /** \brief  Method prepares plan of pricing holding all market independent parts of pricing PDE
+   *
+   *  The steps of algorithm are as follows:
+   * - Obtaining concentration point and limits of the grid 
+   * - Creating the grid
+   * - Calculating initial condition
+   * - Obtaining boundary condition   
+   * - Discretizing differential operators on the grid (see PricingPlan)
+   *
+   * Range of the grid and boundary conditions are set for provided market. Plan can be used to price the option
+   * for other markets (for example intraday updates of market data), as long as the spot lies inside the grid.
+   *
+   * \param mkt Market data used to set the range of grid and boundary conditions
+   * \param option Financial option
+   * \param Ns Number of spatial steps, default number 100
+   * \param Nt Number of time steps, default number 200
+   */
+  PricingPlan FDMPricer::prepare(Market mkt, SmartPointer<Option> option, int Ns, int Nt) const {
+    return prepare(mkt, option, Ns, Nt, -1, -1);
+  }
+
+  /** \brief  Method prepares plan of pricing with spot (and concentration point) placed on given nodes of the grid
+   *
+   * Grid is built as in prepare and mapped linearly (in log-spot) so that the node \b spot_node lies at spot.
+   * Bound of the grid given by the option (e.g. barrier) stays fixed, bound set by range setup is moved
+   * (upper bound if both are set by range setup). If both bounds are given by the option, the grid is not changed.
+   * If both bounds are set by range setup, node \b kink_node is placed at concentration point of the option
+   * (strike, where the payoff has a kink) as well.
+   * Uniform grid stays uniform and nested grids stay nested, as long as the same nodes are moved.
+   *
+   * \param mkt Market data used to set the range of grid and boundary conditions
+   * \param option Financial option
+   * \param Ns Number of spatial steps
+   * \param Nt Number of time steps
+   * \param spot_node Index of the node placed at spot, negative value leaves the grid as built
+   * \param kink_node Index of the node placed at concentration point, negative value or \b spot_node leaves it between the nodes
+   */
+  PricingPlan FDMPricer::prepare(Market mkt, SmartPointer<Option> option, int Ns, int Nt, int spot_node, int kink_node) const {
     auto factory = option->allocateFactory();
     // Generating grid's range and concentration points
     auto low = factory->lowerSpotLmt();
     auto upp = factory->upperSpotLmt();
     auto concentration_point = factory->getConcentrationPoint();
+    bool free_low = low == 0.0;
+    bool free_upp = upp == INFTY;
 	
 	// Converting infinite range to finite 
-    if (low == 0.0) {
+    if (free_low) {
       low = range_setter_->getLowerBound(mkt, option);
     }
-    if (upp == INFTY) {
+    if (free_upp) {
       upp = range_setter_->getUpperBound(mkt, option);
     }
   
     // Generating grid
     auto sgrid = sgrid_->buildGrid(std::log(low), std::log(upp), Ns, concentration_point);
+    if (spot_node > 0 && spot_node < Ns - 1 && (free_low || free_upp)) {
+      // linear map x -> origin + (x - pivot) * ratio moving spot_node to spot
+      double x = std::log(mkt.spot);
+      double pivot = free_upp ? sgrid.front() : sgrid.back();
+      double origin = pivot;
+      double ratio = (x - pivot) / (sgrid.at(spot_node) - pivot);
+      bool kink = free_low && free_upp && kink_node > 0 && kink_node < Ns - 1 && kink_node != spot_node;
+      if (kink) {
+	pivot = sgrid.at(spot_node);
+	origin = x;
+	ratio = (std::log(concentration_point) - x) / (sgrid.at(kink_node) - pivot);
+      }
+      for (auto& node : sgrid) {
+	node = origin + (node - pivot) * ratio;
+      }
+      sgrid.at(spot_node) = x;
+      if (kink) {
+	sgrid.at(kink_node) = std::log(concentration_point);
+      }
+      if (free_low) {
+	low = std::exp(sgrid.front());
+      }
+      if (free_upp) {
+	upp = std::exp(sgrid.back());
+      }
+    }
     auto tgrid = tgrid_->buildGrid(0.0, option->getT(), Nt, 0.0);
     
     // Initial condition
@@ -104,13 +436,7 @@ namespace marian {
 	
     // Boundary conditions
     auto boundary_condition = factory->getBoundarySpotConditions(mkt, low, upp);
-
-	// Generating stochastic process from market data
-    ConvectionDiffusion diffusion = mkt2process(mkt);
-
-	// Formulating PDE problem
-    BackwardKolmogorowEquation bpde(diffusion);
-    bpde.solveAndSave(scheme_, initial,  boundary_condition, sgrid, tgrid, file);
+    return PricingPlan(sgrid, grid, tgrid, initial, boundary_condition);
   }
   
 }  // namespace marian
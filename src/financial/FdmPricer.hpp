@@ -1,14 +1,29 @@
 #ifndef MARIAN_FDMPRIZER_H
 #define MARIAN_FDMPRIZER_H
 
+#include <thread>
 #include <FDM/schemes/fdScheme.hpp>
+#include <FDM/schemes/crankNicolsonScheme.hpp>
+#include <FDM/LUSolver.hpp>
 #include <FDM/gridBuilders/gridBuilder.hpp>
 #include <financial/options/option.hpp>
 #include <financial/market.hpp>
+#include <financial/pricingResult.hpp>
+#include <financial/pricingPlan.hpp>
 #include <financial/gridRange/rangeSetup.hpp>
 
 namespace marian {
 
+  /** \ingroup fin
+   * \brief Data structure describing single task of batch pricing (see FDMPricer::priceBatch)
+   */
+  struct PricingRequest {
+    Market market;               ///< Market data
+    SmartPointer<Option> option; ///< Financial option
+    int Ns;                      ///< Number of spatial steps
+    int Nt;                      ///< Number of time steps
+  };
+
   /** \brief Class implements algorithm solving pricing PDE.
    * \ingroup fin
    *
@@ -22,6 +37,21 @@ namespace marian {
    * - FDM Grid builder
    * 
    * Other object required by FDM solver (boundary and initial conditions) are obtained from abstract factory allocated by option being priced
+   *
+   * Market independent part of pricing (grids, initial and boundary conditions, discretized differential operators) can be prepared
+   * once (see prepare) and reused for many markets, e.g. when the same book is repriced with new market data.
+   *
+   * Schemes hold the state of time stepping, so single pricer must not be used by many threads.
+   * Method priceBatch prices many options concurrently, each thread works with its own copy of pricer
+   * (deep copy of scheme, solver and their workspaces).
+   *
+   * Method priceWithGreeks returns delta, gamma and theta calculated from the solution grid without additional solves.
+   * Method priceExtrapolated solves the problem on nested grids and returns Richardson extrapolation of price and greeks
+   * with error estimates.
+   * Method priceWithSensitivities solves the pricing PDE in marian::Dual numbers, so the price and its derivatives with respect to
+   * market inputs are obtained from single solve. The PDE is solved by separate scheme working with dual numbers
+   * (by default Crank-Nicolson scheme with LU solver, see setSensitivityScheme). Method priceAdjoint computes the same derivatives
+   * in adjoint (reverse) mode with the scheme of the pricer, the cost does not depend on the number of parameters.
    */
   class FDMPricer {
   public:
@@ -32,15 +62,41 @@ namespace marian {
 	      SmartPointer<GridBuilder> sgrid,
 	      SmartPointer<GridBuilder> tgrid,
 	      SmartPointer<RangeSetup> range_setter):
-      scheme_(scheme), sgrid_(sgrid), tgrid_(tgrid), range_setter_(range_setter) {
+      scheme_(scheme), dual_scheme_(BasicCrankNicolsonScheme<Dual>()), sgrid_(sgrid), tgrid_(tgrid), range_setter_(range_setter) {
       scheme_->setSolver(solver);
+      dual_scheme_->setSolver(BasicLUSolver<Dual>());
     }
 
+    /** \brief Sets scheme and solver used to solve pricing PDE in dual numbers (see priceWithSensitivities)
+     */
+    void setSensitivityScheme(SmartPointer<BasicFDScheme<Dual> > scheme,
+			      SmartPointer<BasicTridiagonalSolver<Dual> > solver) {
+      dual_scheme_ = scheme;
+      dual_scheme_->setSolver(solver);
+    }
 
+    PricingPlan prepare(Market m, SmartPointer<Option> o, int Ns = 100, int Nt = 200) const;
     double price(Market m, SmartPointer<Option> o, int Ns = 100, int Nt = 200);
+    double price(const PricingPlan& plan, Market m);
+    std::vector<double> priceBatch(const std::vector<PricingRequest>& requests,
+				   unsigned int threads = std::thread::hardware_concurrency()) const;
+    PricingResult priceWithGreeks(Market m, SmartPointer<Option> o, int Ns = 100, int Nt = 200);
+    PricingResult priceWithGreeks(const PricingPlan& plan, Market m);
+    ExtrapolatedResult priceExtrapolated(Market m, SmartPointer<Option> o, int Ns = 100, int Nt = 200, unsigned int levels = 2,
+					 unsigned int threads = std::thread::hardware_concurrency()) const;
+    Dual priceWithSensitivities(Market m, SmartPointer<Option> o, int Ns = 100, int Nt = 200);
+    Dual priceAdjoint(Market m, SmartPointer<Option> o, int Ns = 100, int Nt = 200);
     void solveAndSave(Market market, SmartPointer<Option> option, std::string file, int Ns = 100, int Nt = 200);
   private:
+    PricingPlan prepare(Market m, SmartPointer<Option> o, int Ns, int Nt, int spot_node, int kink_node) const;
+    template<typename Real>
+    std::vector<Real> solvePricingPDE(const PricingPlan& plan,
+				      BasicMarket<Real> mkt,
+				      SmartPointer<BasicFDScheme<Real> > scheme);
+    static double deltaAtSpot(const std::vector<double>& grid, const std::vector<double>& solution, double spot);
+
     SmartPointer<FDScheme> scheme_; /*!< \brief FD scheme (Explicit, Implicit, etc)  */
+    SmartPointer<BasicFDScheme<Dual> > dual_scheme_; /*!< \brief FD scheme working with dual numbers  */
     SmartPointer<GridBuilder> sgrid_; /*!< \brief Algorithm generating spatial grid  */
     SmartPointer<GridBuilder> tgrid_; /*!< \brief Algorithm generating time grid  */
     SmartPointer<RangeSetup> range_setter_;  /*!< \brief Algorithm defining range of grid  */
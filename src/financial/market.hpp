@@ -2,19 +2,37 @@
 #define MARIAN_MARKET_HPP
 
 #include <iostream>
+#include <utils/dualNumber.hpp>
 
 
 namespace marian {
   /** \ingroup fin
    * \brief Data structure holding the market data
+   *
+   * Structure is templated on the type of market inputs (\b Real). Market given in marian::Dual numbers
+   * (see marian::seedMarket) is used to compute derivatives with respect to market inputs.
    */ 
-  struct Market {
-    double spot; ///< Price of underlying 
-    double vol;  ///< Volatility 
-    double r;    ///< Risk free rate
+  template<typename Real>
+  struct BasicMarket {
+    Real spot; ///< Price of underlying 
+    Real vol;  ///< Volatility 
+    Real r;    ///< Risk free rate
   };
 
-  inline std::ostream& operator<<(std::ostream& s, Market& mkt) {
+  /** \ingroup fin
+   * \brief Market data given in doubles
+   */
+  typedef BasicMarket<double> Market;
+
+  /** \ingroup fin
+   * \brief Converts market data to dual numbers seeded with unit tangents in directions of spot (0), volatility (1) and rate (2)
+   */
+  inline BasicMarket<Dual> seedMarket(const Market& mkt) {
+    return BasicMarket<Dual> {Dual(mkt.spot, 0), Dual(mkt.vol, 1), Dual(mkt.r, 2)};
+  }
+
+  template<typename Real>
+  inline std::ostream& operator<<(std::ostream& s, BasicMarket<Real>& mkt) {
     s << "Spot: " << mkt.spot << " Vol " << mkt.vol << " Rate " << mkt.r << "\n"; 
     return s;
   }
@@ -0,0 +1,24 @@
+#include <financial/pricingPlan.hpp>
+
+namespace marian {
+
+  /** \brief Constructor
+   *
+   * Calculates reversed time grid and differential operators on spatial grid.
+   *
+   * \param sgrid Spatial grid (logarithm of spot)
+   * \param grid Spot grid
+   * \param tgrid Time grid
+   * \param initial Initial condition
+   * \param boundary_condition Boundary conditions
+   */
+  PricingPlan::PricingPlan(const std::vector<double>& sgrid,
+			   const std::vector<double>& grid,
+			   const std::vector<double>& tgrid,
+			   const std::vector<double>& initial,
+			   const std::vector<SmartPointer<BoundaryCondition> >& boundary_condition):
+    sgrid_(sgrid), tgrid_(tgrid), backward_tgrid_(tgrid.rbegin(), tgrid.rend()), grid_(grid), initial_(initial),
+    boundary_condition_(boundary_condition), d0_(TridiagonalOperator::I(sgrid)), d1_(TridiagonalOperator::DZero(sgrid)),
+    d2_(TridiagonalOperator::DPlusMinus(sgrid)) {}
+
+}  // namespace marian
@@ -0,0 +1,90 @@
+#ifndef MARIAN_PRICINGPLAN_HPP
+#define MARIAN_PRICINGPLAN_HPP
+
+#include <vector>
+#include <utils/smartPointer.hpp>
+#include <FDM/tridiagonalOperator.hpp>
+#include <FDM/boundaryConditions/boundaryCondition.hpp>
+
+namespace marian {
+
+  /** \ingroup fin
+   * \brief Class holds the part of pricing PDE which does not depend on market data
+   *
+   * Plan is prepared by FDMPricer::prepare for given option, numbers of steps, grid builders and range of grid.
+   * It holds grids, initial and boundary conditions and differential operators discretized on the spatial grid.
+   * Pricing with the plan (see FDMPricer::price) only builds the process from market data, combines the operators
+   * into operator of PDE, solves it and interpolates the solution.
+   *
+   * Plan is immutable, so it can be shared by many pricers (for example working in different threads).
+   * Range of grid and boundary conditions are set for the market used in preparation, spot of markets priced with the plan
+   * must lie inside the grid.
+   */
+  class PricingPlan {
+  public:
+    PricingPlan(const std::vector<double>& sgrid,
+		const std::vector<double>& grid,
+		const std::vector<double>& tgrid,
+		const std::vector<double>& initial,
+		const std::vector<SmartPointer<BoundaryCondition> >& boundary_condition);
+
+    /** \brief Returns spatial grid (logarithm of spot)
+     */
+    const std::vector<double>& spatialGrid() const {
+      return sgrid_;
+    }
+    /** \brief Returns time grid
+     */
+    const std::vector<double>& timeGrid() const {
+      return tgrid_;
+    }
+    /** \brief Returns time grid reversed, as it is used by schemes solving backward equation
+     */
+    const std::vector<double>& backwardTimeGrid() const {
+      return backward_tgrid_;
+    }
+    /** \brief Returns spot grid
+     */
+    const std::vector<double>& spotGrid() const {
+      return grid_;
+    }
+    /** \brief Returns initial condition (payoff)
+     */
+    const std::vector<double>& initialCondition() const {
+      return initial_;
+    }
+    /** \brief Returns boundary conditions
+     */
+    const std::vector<SmartPointer<BoundaryCondition> >& boundaryConditions() const {
+      return boundary_condition_;
+    }
+    /** \brief Returns identity operator (see TridiagonalOperator::I)
+     */
+    const TridiagonalOperator& identity() const {
+      return d0_;
+    }
+    /** \brief Returns first derivative operator on spatial grid (see TridiagonalOperator::DZero)
+     */
+    const TridiagonalOperator& firstDerivative() const {
+      return d1_;
+    }
+    /** \brief Returns second derivative operator on spatial grid (see TridiagonalOperator::DPlusMinus)
+     */
+    const TridiagonalOperator& secondDerivative() const {
+      return d2_;
+    }
+  private:
+    std::vector<double> sgrid_;                                     /*!< \brief Spatial grid (logarithm of spot)*/
+    std::vector<double> tgrid_;                                     /*!< \brief Time grid*/
+    std::vector<double> backward_tgrid_;                            /*!< \brief Reversed time grid*/
+    std::vector<double> grid_;                                      /*!< \brief Spot grid*/
+    std::vector<double> initial_;                                   /*!< \brief Initial condition*/
+    std::vector<SmartPointer<BoundaryCondition> > boundary_condition_; /*!< \brief Boundary conditions*/
+    TridiagonalOperator d0_;                                        /*!< \brief Identity operator*/
+    TridiagonalOperator d1_;                                        /*!< \brief First derivative operator*/
+    TridiagonalOperator d2_;                                        /*!< \brief Second derivative operator*/
+  };
+
+}  // namespace marian
+
+#endif /* MARIAN_PRICINGPLAN_HPP */
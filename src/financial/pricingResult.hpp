@@ -0,0 +1,36 @@
+#ifndef MARIAN_PRICINGRESULT_HPP
+#define MARIAN_PRICINGRESULT_HPP
+
+#include <iostream>
+
+namespace marian {
+  /** \ingroup fin
+   * \brief Data structure holding the price and greeks obtained from the solution of pricing PDE
+   */ 
+  struct PricingResult {
+    double price; ///< Price of option
+    double delta; ///< First derivative of price with respect to spot
+    double gamma; ///< Second derivative of price with respect to spot
+    double theta; ///< Derivative of price with respect to time
+  };
+
+  inline std::ostream& operator<<(std::ostream& s, const PricingResult& res) {
+    s << "Price: " << res.price << " Delta " << res.delta << " Gamma " << res.gamma << " Theta " << res.theta << "\n"; 
+    return s;
+  }
+
+  /** \ingroup fin
+   * \brief Data structure holding the price and greeks extrapolated from nested grids together with their error estimates
+   */
+  struct ExtrapolatedResult {
+    PricingResult value;  ///< Extrapolated price and greeks
+    PricingResult error;  ///< Estimates of absolute errors of extrapolated price and greeks
+  };
+
+  inline std::ostream& operator<<(std::ostream& s, const ExtrapolatedResult& res) {
+    s << res.value << "Errors: " << res.error;
+    return s;
+  }
+}  // namespace marian
+
+#endif /* MARIAN_PRICINGRESULT_HPP */
@@ -16,9 +16,13 @@
  * To achieve flexibility of FDM solver algorithm we need to construct building blocks that can be freely interchangeable.
  *  
  */
+#include <FDM/tridiagonalExpression.hpp>
 #include <FDM/tridiagonalOperator.hpp>
+#include <FDM/compactDiscretization.hpp>
 #include <FDM/tridiagonalSolver.hpp>
 #include <FDM/LUSolver.hpp>
+#include <FDM/partitionedSolver.hpp>
+#include <FDM/batchLUSolver.hpp>
 
 /** \defgroup boundary Boundary Conditions 
  * \ingroup fdm
@@ -43,14 +47,25 @@
 
 #include <FDM/schemes/fdScheme.hpp>
 #include <FDM/schemes/explicitScheme.hpp>
+#include <FDM/schemes/parallelExplicitScheme.hpp>
 #include <FDM/schemes/implicitScheme.hpp>
 #include <FDM/schemes/crankNicolsonScheme.hpp>
+#include <FDM/schemes/trBDF2Scheme.hpp>
+#include <FDM/schemes/rklScheme.hpp>
+#include <FDM/schemes/mixedPrecisionScheme.hpp>
+#include <FDM/schemes/batchThetaScheme.hpp>
+#include <FDM/schemes/adaptiveScheme.hpp>
+#include <FDM/schemes/spectralScheme.hpp>
+#include <FDM/schemes/pararealScheme.hpp>
+#include <FDM/schemes/autoScheme.hpp>
  
 /** \defgroup fin Financial engineering 
  * \brief General financial engineering objects
  */
 #include <financial/market.hpp>
+#include <financial/pricingResult.hpp>
 #include <financial/analyticPricer.hpp>
+#include <financial/pricingPlan.hpp>
 #include <financial/FdmPricer.hpp>
 /** \defgroup gridrange Grid Ranges
  * \ingroup fin
@@ -77,6 +92,9 @@
 #include <utils/dataFrame.hpp>
 #include <utils/utils.hpp>
 #include <utils/mathUtils.hpp>
+#include <utils/parallel.hpp>
+#include <utils/dualNumber.hpp>
+#include <utils/fft.hpp>
 
 #endif /* _ALL_MARIAN*/
 
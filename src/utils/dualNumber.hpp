@@ -0,0 +1,187 @@
+#ifndef MARIAN_DUALNUMBER_HPP
+#define MARIAN_DUALNUMBER_HPP
+
+#include <array>
+#include <cmath>
+#include <iostream>
+
+namespace marian {
+
+  /** \ingroup utils
+   * \brief Dual number used in forward mode of automatic differentiation
+   *
+   * Number holds value \f$v\f$ and \b N tangents \f$\partial v/\partial x_k\f$ (derivatives with respect to \b N inputs).
+   * Arithmetic operations apply the chain rule to the tangents, so the result of any computation performed on dual numbers
+   * carries derivatives of the result with respect to the inputs:
+   * \f[ (a,\nabla a) \cdot (b,\nabla b) = (ab, a\nabla b + b\nabla a) \f]
+   * Inputs are seeded with unit tangent in their own direction (see constructor).
+   *
+   * Dual numbers are supported type of elements of operators, solvers and schemes, so single solve of PDE
+   * gives the solution together with its derivatives. Cost of single operation grows linearly with \b N.
+   */
+  template<unsigned int N>
+  class DualNumber {
+  public:
+    /** \brief Constructor of constant (all tangents equal to zero)
+     *
+     * \param value Value of number
+     */
+    DualNumber(double value = 0.0):
+      value_(value) {
+      tangent_.fill(0.0);
+    };
+
+    /** \brief Constructor of input variable (seeded tangent)
+     *
+     * \param value Value of number
+     * \param direction Index of input, tangent in this direction is set to 1.0
+     */
+    DualNumber(double value, unsigned int direction):
+      DualNumber(value) {
+      tangent_.at(direction) = 1.0;
+    };
+
+    /** \brief Constructor of number with given tangents
+     *
+     * \param value Value of number
+     * \param tangent Derivatives with respect to inputs
+     */
+    DualNumber(double value, const std::array<double, N>& tangent):
+      value_(value), tangent_(tangent) {};
+
+    /** \brief Returns value of number
+     */
+    double value() const {
+      return value_;
+    }
+    /** \brief Returns derivative with respect to input \b k
+     */
+    double tangent(unsigned int k) const {
+      return tangent_[k];
+    }
+    /** \brief Conversion to double dropping the tangents
+     */
+    explicit operator double() const {
+      return value_;
+    }
+
+    DualNumber& operator+=(const DualNumber& x) {
+      value_ += x.value_;
+      for (unsigned int k = 0; k < N; ++k) {
+	tangent_[k] += x.tangent_[k];
+      }
+      return *this;
+    }
+    DualNumber& operator-=(const DualNumber& x) {
+      value_ -= x.value_;
+      for (unsigned int k = 0; k < N; ++k) {
+	tangent_[k] -= x.tangent_[k];
+      }
+      return *this;
+    }
+    DualNumber& operator*=(const DualNumber& x) {
+      for (unsigned int k = 0; k < N; ++k) {
+	tangent_[k] = tangent_[k] * x.value_ + value_ * x.tangent_[k];
+      }
+      value_ *= x.value_;
+      return *this;
+    }
+    DualNumber& operator/=(const DualNumber& x) {
+      double inv = 1.0 / x.value_;
+      value_ *= inv;
+      for (unsigned int k = 0; k < N; ++k) {
+	tangent_[k] = (tangent_[k] - value_ * x.tangent_[k]) * inv;
+      }
+      return *this;
+    }
+    DualNumber& operator*=(double x) {
+      value_ *= x;
+      for (unsigned int k = 0; k < N; ++k) {
+	tangent_[k] *= x;
+      }
+      return *this;
+    }
+    DualNumber& operator/=(double x) {
+      return *this *= 1.0 / x;
+    }
+
+    friend DualNumber operator-(DualNumber x) {
+      return x *= -1.0;
+    }
+    friend DualNumber operator+(DualNumber x, const DualNumber& y) {
+      return x += y;
+    }
+    friend DualNumber operator-(DualNumber x, const DualNumber& y) {
+      return x -= y;
+    }
+    friend DualNumber operator*(DualNumber x, const DualNumber& y) {
+      return x *= y;
+    }
+    friend DualNumber operator/(DualNumber x, const DualNumber& y) {
+      return x /= y;
+    }
+    friend DualNumber operator*(DualNumber x, double y) {
+      return x *= y;
+    }
+    friend DualNumber operator*(double x, DualNumber y) {
+      return y *= x;
+    }
+    friend DualNumber operator/(DualNumber x, double y) {
+      return x /= y;
+    }
+
+    /** \brief Numbers are equal if values and all tangents are equal
+     */
+    friend bool operator==(const DualNumber& x, const DualNumber& y) {
+      return x.value_ == y.value_ && x.tangent_ == y.tangent_;
+    }
+    friend bool operator!=(const DualNumber& x, const DualNumber& y) {
+      return !(x == y);
+    }
+
+    friend DualNumber exp(DualNumber x) {
+      double e = std::exp(x.value_);
+      x.value_ = 1.0;
+      x *= e;
+      return x;
+    }
+    friend DualNumber log(DualNumber x) {
+      double l = std::log(x.value_);
+      x /= x.value_;
+      x.value_ = l;
+      return x;
+    }
+    friend DualNumber sqrt(DualNumber x) {
+      double s = std::sqrt(x.value_);
+      x *= 0.5 / s;
+      x.value_ = s;
+      return x;
+    }
+    friend DualNumber pow(DualNumber x, double p) {
+      double v = std::pow(x.value_, p);
+      x *= p * std::pow(x.value_, p - 1.0);
+      x.value_ = v;
+      return x;
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, const DualNumber& x) {
+      s << x.value_ << "[";
+      for (unsigned int k = 0; k < N; ++k) {
+	s << (k > 0 ? " " : "") << x.tangent_[k];
+      }
+      s << "]";
+      return s;
+    }
+  private:
+    double value_;                   /*!< \brief Value of number*/
+    std::array<double, N> tangent_;  /*!< \brief Derivatives with respect to inputs*/
+  };
+
+  /** \ingroup utils
+   * \brief Dual number carrying derivatives with respect to market inputs: spot (0), volatility (1) and risk free rate (2)
+   */
+  typedef DualNumber<3> Dual;
+
+} // namespace marian
+
+#endif /* MARIAN_DUALNUMBER_HPP */
@@ -0,0 +1,111 @@
+#include <utils/fft.hpp>
+#include <cmath>
+
+namespace marian {
+
+  /** \brief Radix-2 Cooley-Tukey transform of vector of length equal to power of two (without normalization)
+   */
+  static void radix2(std::vector<std::complex<double> >& a, bool inverse) {
+    unsigned int n = a.size();
+    for (unsigned int i = 1, j = 0; i < n; ++i) {
+      unsigned int bit = n >> 1;
+      for (; j & bit; bit >>= 1) {
+	j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) {
+	std::swap(a[i], a[j]);
+      }
+    }
+    const double pi = std::acos(-1.0);
+    for (unsigned int len = 2; len <= n; len <<= 1) {
+      double angle = (inverse ? 2.0 : -2.0) * pi / len;
+      for (unsigned int k = 0; k < len / 2; ++k) {
+	std::complex<double> w = std::polar(1.0, angle * k);
+	for (unsigned int i = k; i < n; i += len) {
+	  std::complex<double> u = a[i];
+	  std::complex<double> v = a[i + len / 2] * w;
+	  a[i] = u + v;
+	  a[i + len / 2] = u - v;
+	}
+      }
+    }
+  }
+
+  /** \ingroup utils
+   * \brief Discrete Fourier transform of vector of any length
+   *
+   * Computes \f$A_k = \sum_j a_j e^{\mp 2\pi i jk/n}\f$ (sign minus for forward transform) without normalization.
+   * Vectors of length equal to power of two are transformed by radix-2 algorithm, other lengths by Bluestein algorithm,
+   * which expresses the transform as convolution computed with radix-2 transforms. Cost is \f$O(n \log n)\f$ for any \f$n\f$.
+   *
+   * \param a Vector overwritten by its transform
+   * \param inverse If true, sign of exponent is plus
+   */
+  void fft(std::vector<std::complex<double> >& a, bool inverse) {
+    unsigned int n = a.size();
+    if (n <= 1) {
+      return;
+    }
+    if ((n & (n - 1)) == 0) {
+      radix2(a, inverse);
+      return;
+    }
+
+    // jk = (j^2 + k^2 - (k-j)^2) / 2, so the transform is convolution of a_j c_j with conj(c_j), where c_j = exp(-i pi j^2 / n)
+    const double pi = std::acos(-1.0);
+    unsigned int m = 1;
+    while (m < 2 * n - 1) {
+      m <<= 1;
+    }
+    std::vector<std::complex<double> > chirp(n);
+    for (unsigned int j = 0; j < n; ++j) {
+      unsigned long long square = static_cast<unsigned long long>(j) * j % (2ull * n);
+      chirp[j] = std::polar(1.0, (inverse ? pi : -pi) * square / n);
+    }
+    std::vector<std::complex<double> > u(m), v(m);
+    for (unsigned int j = 0; j < n; ++j) {
+      u[j] = a[j] * chirp[j];
+    }
+    v[0] = std::conj(chirp[0]);
+    for (unsigned int j = 1; j < n; ++j) {
+      v[j] = v[m - j] = std::conj(chirp[j]);
+    }
+    radix2(u, false);
+    radix2(v, false);
+    for (unsigned int j = 0; j < m; ++j) {
+      u[j] *= v[j];
+    }
+    radix2(u, true);
+    for (unsigned int k = 0; k < n; ++k) {
+      a[k] = u[k] * chirp[k] / static_cast<double>(m);
+    }
+  }
+
+  /** \ingroup utils
+   * \brief Discrete sine transform (DST-I)
+   *
+   * Computes \f$X_k = \sum_{j=1}^{n} x_j \sin\big(\frac{\pi jk}{n+1}\big)\f$ for \f$k = 1, \dots, n\f$ from the Fourier transform
+   * of odd extension of \f$x\f$ of length \f$2(n+1)\f$. Transform is its own inverse up to factor \f$\frac{2}{n+1}\f$.
+   * Sine vectors are eigenvectors of tridiagonal Toeplitz matrices with zero boundary values, so the transform
+   * diagonalizes operators with constant coefficients on uniform grids.
+   *
+   * \param x Vector \f$(x_1, \dots, x_n)\f$
+   * \return Vector \f$(X_1, \dots, X_n)\f$
+   */
+  std::vector<double> sineTransform(const std::vector<double>& x) {
+    unsigned int n = x.size();
+    std::vector<std::complex<double> > extension(2 * (n + 1));
+    for (unsigned int j = 0; j < n; ++j) {
+      extension[j + 1] = x[j];
+      extension[2 * (n + 1) - (j + 1)] = -x[j];
+    }
+    fft(extension);
+    std::vector<double> ret(n);
+    for (unsigned int k = 0; k < n; ++k) {
+      ret[k] = -0.5 * extension[k + 1].imag();
+    }
+    return ret;
+  }
+
+}  // namespace marian
@@ -0,0 +1,15 @@
+#ifndef MARIAN_FFT_HPP
+#define MARIAN_FFT_HPP
+
+#include <complex>
+#include <vector>
+
+namespace marian {
+
+  void fft(std::vector<std::complex<double> >& a, bool inverse = false);
+
+  std::vector<double> sineTransform(const std::vector<double>& x);
+
+} // namespace marian
+
+#endif /* MARIAN_FFT_HPP */
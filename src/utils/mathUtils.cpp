@@ -59,5 +59,33 @@ namespace marian {
     return (y.at(position-1) * ( x.at(position) - t) + y.at(position) * (t
 									 - x.at(position-1)) ) / (x.at(position) - x.at(position-1));
   }
-  
+
+  /** \ingroup utils
+   * \brief Richardson extrapolation of values obtained with step sizes \f$h, h/2, h/4, \dots\f$
+   *
+   * Values are assumed to have error expansion \f$v(h) = v + C_1 h^p + C_2 h^{2p} + \dots\f$. Each column of the Richardson
+   * table removes the next term of the expansion:
+   * \f[ v_i^{(k)} = v_i^{(k-1)} + \frac{v_i^{(k-1)} - v_{i-1}^{(k-1)}}{2^{kp} - 1} \f]
+   * Error of the result is estimated by its difference from the best value of the previous column.
+   *
+   * \param values Values obtained with successively halved step size
+   * \param order Order \f$p\f$ of the leading error term
+   * \param error Overwritten by error estimate of the result (zero for single value)
+   * \return Extrapolated value
+   */
+  double richardsonExtrapolation(std::vector<double> values,
+				 double order,
+				 double& error) {
+    error = 0.0;
+    for (unsigned int k = 1; k < values.size(); ++k) {
+      double previous = values.back();
+      double factor = std::pow(2.0, k * order) - 1.0;
+      for (unsigned int i = values.size() - 1; i >= k; --i) {
+	values[i] += (values[i] - values[i-1]) / factor;
+      }
+      error = std::fabs(values.back() - previous);
+    }
+    return values.back();
+  }
+
 }  // namespace marian
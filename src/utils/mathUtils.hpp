@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <limits>
+#include <algorithm>
+#include <utils/dualNumber.hpp>
 namespace marian {
 
   #define INFTY std::numeric_limits<double>::infinity()
@@ -12,6 +14,31 @@ namespace marian {
   double interpolation(const std::vector<double>& x,
 		       const std::vector<double>& y,
 		       double t);
+
+  double richardsonExtrapolation(std::vector<double> values,
+				 double order,
+				 double& error);
+
+  /** \ingroup utils
+   * \brief linear local interpolation of dual numbers
+   *
+   * Values and tangents are interpolated with the same weights as in interpolation of doubles.
+   * Tangents of the intermediate point \b t are propagated by the slope of the interpolant.
+   *
+   * \param x Vector of arguments
+   * \param y Vector of values corresponding to arguments
+   * \param t Intermediate point
+   * \return Value of interpolant for t
+   * \pre x,y vector must be sorted.
+   */
+  template<unsigned int N>
+  DualNumber<N> interpolation(const std::vector<double>& x,
+			      const std::vector<DualNumber<N> >& y,
+			      const DualNumber<N>& t) {
+    unsigned int position = std::lower_bound(x.begin(), x.end(), t.value()) - x.begin();
+
+    return (y.at(position-1) * (x.at(position) - t) + y.at(position) * (t - x.at(position-1))) / (x.at(position) - x.at(position-1));
+  }
   
   
 } // namespace  marian
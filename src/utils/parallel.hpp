@@ -0,0 +1,240 @@
+#ifndef MARIAN_PARALLEL_HPP
+#define MARIAN_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace marian {
+
+  /** \brief Barrier synchronizing fixed number of threads
+   *
+   * Each call of wait blocks until all threads called it, then the barrier is ready for the next phase.
+   * Threads spin on the number of passed phases (yielding the processor), so the barrier is cheap when it is passed
+   * many times per second, e.g. once per time step of the scheme. Threads waiting longer than SPIN_LIMIT yields
+   * fall asleep on condition variable, so idle threads (e.g. workers of WorkerPool between solves) do not occupy processors.
+   */
+  class Barrier {
+  public:
+    /** \brief Constructor
+     *
+     * \param count Number of synchronized threads
+     */
+    explicit Barrier(unsigned int count):
+      count_(count), arrived_(0), phase_(0) {};
+
+    /** \brief Blocks until all threads reach the barrier
+     */
+    void wait() {
+      unsigned int phase = phase_.load();
+      if (arrived_.fetch_add(1) + 1 == count_) {
+	arrived_.store(0);
+	{
+	  std::lock_guard<std::mutex> lock(mutex_);
+	  phase_.fetch_add(1);
+	}
+	wake_.notify_all();
+	return;
+      }
+      for (unsigned int i = 0; i < SPIN_LIMIT; ++i) {
+	if (phase_.load() != phase) {
+	  return;
+	}
+	std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return phase_.load() != phase; });
+    }
+  private:
+    static const unsigned int SPIN_LIMIT = 10000; /*!< \brief Number of yields before waiting thread falls asleep*/
+
+    unsigned int count_;                /*!< \brief Number of synchronized threads*/
+    std::atomic<unsigned int> arrived_; /*!< \brief Number of threads waiting in actual phase*/
+    std::atomic<unsigned int> phase_;   /*!< \brief Number of passed phases*/
+    std::mutex mutex_;                  /*!< \brief Guards sleeping on condition variable*/
+    std::condition_variable wake_;      /*!< \brief Wakes sleeping threads when phase is passed*/
+  };
+
+  /** \brief Pool of persistent threads executing tasks 0, 1, ..., n-1 concurrently
+   *
+   * Works like parallelFor, but threads are started by the first call of run and reused by the next calls,
+   * so the cost of starting threads is paid once instead of on every call (e.g. twice per time step in marian::BasicPartitionedSolver).
+   * Start and end of each call are synchronized with Barrier. Pool is restarted only if number of tasks changes.
+   *
+   * Copy of pool does not share the threads, it starts its own threads when used, so objects owning the pool
+   * keep default copy semantics (e.g. copies of solvers used by different threads in FDMPricer::priceBatch).
+   * Single pool must not be used by many threads at the same time.
+   */
+  class WorkerPool {
+  public:
+    /** \brief Constructor
+     */
+    WorkerPool() {};
+    /** \brief Copy constructor, copy starts its own threads
+     */
+    WorkerPool(const WorkerPool&) {};
+    /** \brief Assignment keeps threads of the pool
+     */
+    WorkerPool& operator=(const WorkerPool&) {
+      return *this;
+    }
+
+    /** \brief Executes function for tasks 0, 1, ..., n-1 concurrently
+     *
+     * Task 0 is executed by the calling thread, other tasks by the threads of the pool.
+     * Function returns when all tasks are finished.
+     *
+     * \param n Number of tasks
+     * \param f Function taking index of the task
+     */
+    template<typename F>
+    void run(unsigned int n, const F& f) {
+      if (n <= 1) {
+	if (n == 1) {
+	  f(0u);
+	}
+	return;
+      }
+      if (n != workers_.size() + 1) {
+	stop();
+	start(n);
+      }
+      task_ = &f;
+      call_ = &invoke<F>;
+      start_->wait();
+      f(0u);
+      finish_->wait();
+    }
+
+    /** \brief Destructor, joins the threads
+     */
+    ~WorkerPool() {
+      stop();
+    }
+  private:
+    template<typename F>
+    static void invoke(const void* f, unsigned int k) {
+      (*static_cast<const F*>(f))(k);
+    }
+
+    /** \brief Starts threads executing tasks 1, ..., n-1
+     */
+    void start(unsigned int n) {
+      start_.reset(new Barrier(n));
+      finish_.reset(new Barrier(n));
+      for (unsigned int k = 1; k < n; ++k) {
+	workers_.emplace_back([this, k] {
+	    while (true) {
+	      start_->wait();
+	      if (stopping_) {
+		return;
+	      }
+	      call_(task_, k);
+	      finish_->wait();
+	    }
+	  });
+      }
+    }
+
+    /** \brief Stops and joins the threads
+     */
+    void stop() {
+      if (workers_.empty()) {
+	return;
+      }
+      stopping_ = true;
+      start_->wait();
+      for (auto& t : workers_) {
+	t.join();
+      }
+      workers_.clear();
+      stopping_ = false;
+    }
+
+    std::vector<std::thread> workers_;                /*!< \brief Threads executing tasks 1, ..., n-1*/
+    std::unique_ptr<Barrier> start_;                  /*!< \brief Barrier starting the tasks*/
+    std::unique_ptr<Barrier> finish_;                 /*!< \brief Barrier waiting for the end of the tasks*/
+    const void* task_ = nullptr;                      /*!< \brief Function executed by the tasks*/
+    void (*call_)(const void*, unsigned int) = nullptr; /*!< \brief Calls the function with index of the task*/
+    bool stopping_ = false;                           /*!< \brief True if threads are asked to finish*/
+  };
+
+  /** \brief Executes function for tasks 0, 1, ..., n-1 concurrently
+   *
+   * Each task is executed by separate thread, task 0 is executed by the calling thread.
+   * Function returns when all tasks are finished.
+   *
+   * \param n Number of tasks
+   * \param f Function taking index of the task
+   */
+  template<typename F>
+  void parallelFor(unsigned int n, const F& f) {
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    for (unsigned int k = 1; k < n; ++k) {
+      threads.emplace_back(f, k);
+    }
+    if (n > 0) {
+      f(0u);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  /** \brief Executes function for tasks 0, 1, ..., n-1 on given number of threads with work stealing
+   *
+   * Tasks are divided into equal contiguous ranges, one for each thread. Thread executes tasks from the front of its own range,
+   * when the range is empty it steals tasks from the back of ranges of other threads. Tasks of different cost (e.g. pricing PDEs
+   * with different grids) are balanced between threads without central queue.
+   * Function returns when all tasks are finished.
+   *
+   * \param n Number of tasks
+   * \param threads Number of threads
+   * \param f Function taking index of the thread and index of the task
+   */
+  template<typename F>
+  void workStealingFor(unsigned int n, unsigned int threads, const F& f) {
+    struct Range {
+      std::mutex mutex;   // guards the range
+      unsigned int begin; // first task not taken
+      unsigned int end;   // end of tasks not taken
+    };
+    threads = std::max(1u, std::min(threads, n));
+    std::vector<Range> ranges(threads);
+    for (unsigned int k = 0; k < threads; ++k) {
+      ranges[k].begin = static_cast<unsigned long>(n) * k / threads;
+      ranges[k].end = static_cast<unsigned long>(n) * (k + 1) / threads;
+    }
+
+    parallelFor(threads, [&](unsigned int k) {
+	while (true) {
+	  unsigned int task = n;
+	  {
+	    std::lock_guard<std::mutex> lock(ranges[k].mutex);
+	    if (ranges[k].begin < ranges[k].end) {
+	      task = ranges[k].begin++;
+	    }
+	  }
+	  for (unsigned int j = 1; j < threads && task == n; ++j) {
+	    Range& victim = ranges[(k + j) % threads];
+	    std::lock_guard<std::mutex> lock(victim.mutex);
+	    if (victim.begin < victim.end) {
+	      task = --victim.end;
+	    }
+	  }
+	  if (task == n) {
+	    return;
+	  }
+	  f(k, task);
+	}
+      });
+  }
+
+} // namespace marian
+
+#endif /* MARIAN_PARALLEL_HPP */
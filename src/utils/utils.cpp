@@ -75,10 +75,17 @@ namespace marian {
    * 
    * Above PDE is a Backward Kolmogorov Equation  associated with stochastic process: diffusion term \f$\frac{\sigma^2}{2}\f$, convection term \f$r-\frac{\sigma^2}{2}\f$ and decay term \f$r\f$.  
    * 
+   * Function is templated on the type of market inputs, for market given in marian::Dual numbers the parameters of the process
+   * carry derivatives with respect to market inputs.
    */
-  ConvectionDiffusion mkt2process(Market mkt) {
-    ConvectionDiffusion diffusion {mkt.vol, mkt.r-mkt.vol*mkt.vol*0.5, mkt.r};
+  template<typename Real>
+  BasicConvectionDiffusion<Real> mkt2process(BasicMarket<Real> mkt) {
+    BasicConvectionDiffusion<Real> diffusion {mkt.vol, mkt.r-mkt.vol*mkt.vol*0.5, mkt.r};
     return diffusion;
   }
 
+  // instantiations for supported types of market inputs
+  template ConvectionDiffusion mkt2process(Market mkt);
+  template BasicConvectionDiffusion<Dual> mkt2process(BasicMarket<Dual> mkt);
+
 }  // namespace marian
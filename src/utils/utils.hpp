@@ -16,7 +16,8 @@ namespace marian {
   
   std::map<std::string, Market>  createMarkets(DataFrame df);
 
-  ConvectionDiffusion mkt2process(Market mkt);
+  template<typename Real>
+  BasicConvectionDiffusion<Real> mkt2process(BasicMarket<Real> mkt);
   
 } // namespace marian
 